@@ -2,6 +2,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstring>
+#include <strings.h>
 #include <array>
 #include <string>
 #include <set>
@@ -11,10 +12,19 @@
 #include <iostream>
 #include <deque>
 #include <map>
+#include <queue>
 #include <thread>
 #include <functional>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <mutex>
+#include <condition_variable>
 #include <signal.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #ifndef M_PI
 #define M_PI 3.14159
@@ -34,7 +44,77 @@ struct system_clock
         phase_hpe = (phase_hpe + elapsed_cpu) % 65;
         if(0) printf("added %llu, new cpu clock %llu, 14mhz clock %llu, phase %llu\n", elapsed_cpu, clock_cpu, clock_14mhz, phase_hpe);
     }
-} clk;
+};
+
+// Something a device needs done once the CPU clock reaches a deadline,
+// like a timer running out.  Each device keeps its own and reschedules it
+// as its state changes.
+struct scheduled_event
+{
+    static constexpr clk_t never = std::numeric_limits<clk_t>::max();
+    clk_t when = never; // CPU clock
+    uint64_t generation = 0; // heap entries from other schedulings are stale
+    std::function<void ()> action;
+};
+
+// Events in a min-heap on their CPU clock deadlines, so the CPU can run
+// uninterrupted until the earliest one instead of every device checking
+// the clock after every instruction.  Rescheduling an event leaves its
+// old entry in the heap to be dropped when it reaches the top.
+struct event_scheduler
+{
+    typedef std::tuple<clk_t, uint64_t, scheduled_event*> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> heap;
+    uint64_t generation = 0;
+    clk_t earliest = scheduled_event::never; // no deadline is before this
+
+    void schedule(scheduled_event& e, clk_t when)
+    {
+        if(when == e.when) {
+            return;
+        }
+        e.when = when;
+        e.generation = ++generation;
+        if(when != scheduled_event::never) {
+            heap.push(entry(when, e.generation, &e));
+            earliest = std::min(earliest, when);
+        }
+    }
+
+    // Also drops e's heap entries, so e may be destroyed afterwards
+    void cancel(scheduled_event& e)
+    {
+        e.when = scheduled_event::never;
+        std::vector<entry> kept;
+        for(; !heap.empty(); heap.pop()) {
+            if(std::get<2>(heap.top()) != &e) {
+                kept.push_back(heap.top());
+            }
+        }
+        heap = decltype(heap)(std::greater<entry>(), std::move(kept));
+    }
+
+    clk_t next_deadline()
+    {
+        while(!heap.empty() && (std::get<1>(heap.top()) != std::get<2>(heap.top())->generation)) {
+            heap.pop();
+        }
+        earliest = heap.empty() ? scheduled_event::never : std::get<0>(heap.top());
+        return earliest;
+    }
+
+    // Run the events with deadlines at or before now, earliest first
+    void run_due(clk_t now)
+    {
+        while(next_deadline() <= now) {
+            scheduled_event *e = std::get<2>(heap.top());
+            heap.pop();
+            e->when = scheduled_event::never;
+            e->generation = ++generation;
+            e->action();
+        }
+    }
+};
 
 
 #if 0
@@ -64,6 +144,7 @@ void PrintToLine3(const char *fmt, ...)
 
 // Brad's 6502
 #include "cpu6502.h"
+#include "cpu6502_jit.h"
 
 #undef SUPPORT_FAKE_6502
 
@@ -77,6 +158,7 @@ using namespace std;
 #include "emulator.h"
 #include "dis6502.h"
 #include "interface.h"
+#include "video_render.h"
 
 #define LK_HACK 0
 
@@ -95,14 +177,13 @@ bool delete_is_left_arrow = true;
 volatile bool exit_on_banking = false;
 volatile bool exit_on_memory_fallthrough = true;
 volatile bool run_fast = false;
+bool warp_while_disk_motor_on = false;
+volatile bool disk_warping = false; // running fast only because a drive motor is on
 volatile bool pause_cpu = false;
 
 bool run_rate_limited = false;
 int rate_limit_millis;
 
-// XXX - this should be handled through a function passed to MAINboard
-APPLE2Einterface::ModeHistory mode_history;
-
 const float paddle_max_pulse_seconds = .00282;
 
 // Map from memory address to name of function (from the ld65 map file).
@@ -238,9 +319,67 @@ typedef std::function<bool()> enabled_func;
 
 enum MemoryType {RAM, ROM};
 
+// Memory kept as 256-byte pages so a forked machine can share pages with
+// the machine it was forked from.  A page in use by more than one machine
+// is copied by writable_page() before it's changed.
+struct paged_memory
+{
+    typedef std::array<uint8_t,256> page;
+    vector<shared_ptr<page>> pages;
+
+    paged_memory(int size)
+    {
+        assert(size % 256 == 0);
+        for(int i = 0; i < size / 256; i++) {
+            pages.push_back(make_shared<page>()); // zero filled
+        }
+    }
+
+    int size() const { return pages.size() * 256; }
+    uint8_t operator[](int offset) const { return (*pages[offset / 256])[offset % 256]; }
+
+    const uint8_t *page_data(int n) const { return pages[n]->data(); }
+    bool page_shared(int n) const { return pages[n].use_count() > 1; }
+
+    uint8_t *writable_page(int n)
+    {
+        if(page_shared(n)) {
+            pages[n] = make_shared<page>(*pages[n]);
+        } else {
+            // See the other machine's last reads before writing
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return pages[n]->data();
+    }
+
+    void set(int offset, uint8_t data)
+    {
+        writable_page(offset / 256)[offset % 256] = data;
+    }
+
+    void copy_in(const uint8_t *data, size_t size)
+    {
+        for(size_t i = 0; i < size; i += 256) {
+            std::copy(data + i, data + i + 256, writable_page(i / 256));
+        }
+    }
+
+    void copy_out(uint8_t *data) const
+    {
+        for(size_t n = 0; n < pages.size(); n++) {
+            std::copy(pages[n]->begin(), pages[n]->end(), data + n * 256);
+        }
+    }
+
+    void share(const paged_memory& other)
+    {
+        pages = other.pages;
+    }
+};
+
 struct backed_region : region
 {
-    vector<uint8_t> memory;
+    paged_memory memory;
     MemoryType type;
     enabled_func read_enabled;
     enabled_func write_enabled;
@@ -252,7 +391,6 @@ struct backed_region : region
         read_enabled(enabled_),
         write_enabled(enabled_)
     {
-        std::fill(memory.begin(), memory.end(), 0x00);
         if(regions)
             regions->push_back(this);
     }
@@ -264,7 +402,6 @@ struct backed_region : region
         read_enabled(read_enabled_),
         write_enabled(write_enabled_)
     {
-        std::fill(memory.begin(), memory.end(), 0x00);
         if(regions)
             regions->push_back(this);
     }
@@ -286,7 +423,7 @@ struct backed_region : region
     bool write(int addr, uint8_t data)
     {
         if((type == RAM) && contains(addr) && write_enabled()) {
-            memory[addr - base] = data;
+            memory.set(addr - base, data);
             return true;
         }
         return false;
@@ -295,6 +432,97 @@ struct backed_region : region
 
 const region io_region = {"io", 0xC000, 0x100};
 
+// Save states are written and read by the same transfer_state() functions,
+// so the order of values can't differ between the two.  Values are stored
+// in host byte order; a state is meant to be loaded by the same build.
+// Forking a machine goes through a buffer in memory instead of a file and
+// leaves out RAM, whose pages are shared instead.
+struct state_writer
+{
+    static constexpr bool loading = false;
+    FILE *fp = nullptr;
+    vector<uint8_t> *buffer = nullptr;
+    bool with_memory = true;
+    bool ok = true;
+
+    state_writer(FILE *fp_) : fp(fp_) {}
+    state_writer(vector<uint8_t> *buffer_) : buffer(buffer_), with_memory(false) {}
+
+    void bytes(void *data, size_t size)
+    {
+        if(buffer) {
+            buffer->insert(buffer->end(), static_cast<uint8_t*>(data), static_cast<uint8_t*>(data) + size);
+        } else if(ok && (fwrite(data, 1, size, fp) != size)) {
+            ok = false;
+        }
+    }
+    template <class T>
+    void value(T& v)
+    {
+        bytes(&v, sizeof(v));
+    }
+    void text(string& str)
+    {
+        uint32_t length = str.size();
+        value(length);
+        bytes(&str[0], length);
+    }
+};
+
+struct state_reader
+{
+    static constexpr bool loading = true;
+    static constexpr uint32_t max_text_length = 4096;
+    FILE *fp = nullptr;
+    const vector<uint8_t> *buffer = nullptr;
+    size_t buffer_offset = 0;
+    bool with_memory = true;
+    bool ok = true;
+
+    state_reader(FILE *fp_) : fp(fp_) {}
+    state_reader(const vector<uint8_t> *buffer_) : buffer(buffer_), with_memory(false) {}
+
+    void bytes(void *data, size_t size)
+    {
+        if(!ok) {
+            return;
+        }
+        if(buffer) {
+            if(buffer_offset + size > buffer->size()) {
+                ok = false;
+                return;
+            }
+            memcpy(data, buffer->data() + buffer_offset, size);
+            buffer_offset += size;
+        } else if(fread(data, 1, size, fp) != size) {
+            ok = false;
+        }
+    }
+    template <class T>
+    void value(T& v)
+    {
+        bytes(&v, sizeof(v));
+    }
+    void text(string& str)
+    {
+        uint32_t length = 0;
+        value(length);
+        if(length > max_text_length) {
+            ok = false;
+            return;
+        }
+        str.resize(length);
+        bytes(&str[0], length);
+    }
+};
+
+// Case-insensitive, for floppy image extensions
+bool has_suffix(const char *name, const char *suffix)
+{
+    size_t name_length = strlen(name), suffix_length = strlen(suffix);
+    return (name_length >= suffix_length) && (strcasecmp(name + name_length - suffix_length, suffix) == 0);
+}
+
 namespace DiskII
 {
 
@@ -401,30 +629,277 @@ void nybblizeSector(int trackIndex, int sectorIndex, const uint8_t *sectorBytes,
     memcpy(p, sectorFooter, sizeof(sectorFooter));
 }
 
-bool nybblizeTrackFromFile(FILE *floppyImageFile, int trackIndex, uint8_t *nybblizedTrack, const int *skew)
+void nybblizeTrack(const uint8_t *floppyImage, int trackIndex, uint8_t *nybblizedTrack, const int *skew)
 {
     memset(nybblizedTrack, 0xFF, trackGapSize);					// Write gap 1, 64 bytes (self-sync)
 
     for(int sectorIndex = 0; sectorIndex < 16; sectorIndex++)
     {
         uint32_t sectorOffset = (skew[sectorIndex] + trackIndex * sectorsPerTrack) * sectorSize;
-        int seeked = fseek(floppyImageFile, sectorOffset, SEEK_SET);
-        if(seeked == -1) {
-            fprintf(stderr, "failed to seek to sector in floppy disk image\n");
+        uint8_t *sectorDest = nybblizedTrack + trackGapSize + sectorIndex * nybblizedSectorSize;
+
+        nybblizeSector(trackIndex, sectorIndex, floppyImage + sectorOffset, sectorDest);
+    }
+}
+
+static int BytesToSixBits[256]; // -1 for bytes that can't be in a data field
+
+static void initializeBytesToSixBits() __attribute__((constructor));
+void initializeBytesToSixBits()
+{
+    std::fill(BytesToSixBits, BytesToSixBits + 256, -1);
+    for(int i = 0; i < 0x40; i++) {
+        BytesToSixBits[SixBitsToBytes[i]] = i;
+    }
+}
+
+// Undo nybblizeSector() on the 343 bytes of a data field, returning false
+// if they hold a byte that can't be in one or the checksum doesn't match
+bool denybblizeSector(const uint8_t *dataField, uint8_t *sectorBytes)
+{
+    uint8_t p[343];
+    uint8_t previous = 0;
+    for(int i = 0; i < 343; i++) {
+        int sixBits = BytesToSixBits[dataField[i]];
+        if(sixBits < 0) {
+            return false;
+        }
+        p[i] = sixBits ^ previous;
+        previous = p[i];
+    }
+    if(p[342] != 0) {
+        return false;
+    }
+
+    for(int i = 0; i < 256; i++) {
+        uint8_t twoBits;
+        if(i < 0x56) {
+            twoBits = ((p[i] >> 1) & 0x01) | ((p[i] << 1) & 0x02);
+        } else if(i < 0xAC) {
+            twoBits = ((p[i - 0x56] >> 3) & 0x01) | ((p[i - 0x56] >> 1) & 0x02);
+        } else {
+            twoBits = ((p[i - 0xAC] >> 5) & 0x01) | ((p[i - 0xAC] >> 3) & 0x02);
+        }
+        sectorBytes[i] = (p[0x56 + i] << 2) | twoBits;
+    }
+    return true;
+}
+
+// Find each sector's address field in a nybblized track and decode the
+// data field after it into floppyTrack, the track as laid out in the image.
+// sectorValid says which of the track's sectors in the image were found.
+void denybblizeTrack(const uint8_t *nybblizedTrack, int trackIndex, uint8_t *floppyTrack, const int *skew, bool sectorValid[16])
+{
+    auto at = [nybblizedTrack](size_t i) { return nybblizedTrack[i % nybblizedTrackSize]; };
+    auto fourAndFour = [&at](size_t i) { return ((at(i) << 1) | 1) & at(i + 1); };
+
+    std::fill(sectorValid, sectorValid + 16, false);
+
+    for(size_t i = 0; i < nybblizedTrackSize; i++) {
+        if((at(i) != 0xD5) || (at(i + 1) != 0xAA) || (at(i + 2) != 0x96)) {
+            continue;
+        }
+        int volume = fourAndFour(i + 3);
+        int track = fourAndFour(i + 5);
+        int sector = fourAndFour(i + 7);
+        int checksum = fourAndFour(i + 9);
+        if((checksum != (volume ^ track ^ sector)) || (track != trackIndex) || (sector >= sectorsPerTrack)) {
+            continue;
+        }
+
+        // RWTS looks for the data field within a few dozen bytes
+        for(size_t j = i + 11; j < i + 11 + 64; j++) {
+            if((at(j) == 0xD5) && (at(j + 1) == 0xAA) && (at(j + 2) == 0xAD)) {
+                uint8_t dataField[343];
+                for(int k = 0; k < 343; k++) {
+                    dataField[k] = at(j + 3 + k);
+                }
+                if(denybblizeSector(dataField, floppyTrack + skew[sector] * sectorSize)) {
+                    sectorValid[skew[sector]] = true;
+                }
+                break;
+            }
+        }
+    }
+}
+
+// A floppy image file mapped read-only into memory, so inserting one
+// doesn't read the whole file
+struct MappedImage
+{
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+
+    MappedImage() {}
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+    ~MappedImage() { close(); }
+
+    bool open(const char *name)
+    {
+        close();
+        int fd = ::open(name, O_RDONLY);
+        if(fd == -1) {
+            return false;
+        }
+        struct stat st;
+        if(fstat(fd, &st) == -1) {
+            ::close(fd);
             return false;
         }
+        size = st.st_size;
+        if(size > 0) {
+            void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapped == MAP_FAILED) {
+                ::close(fd);
+                size = 0;
+                return false;
+            }
+            data = static_cast<const uint8_t*>(mapped);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    void close()
+    {
+        if(data) {
+            munmap(const_cast<uint8_t*>(data), size);
+        }
+        data = nullptr;
+        size = 0;
+    }
+};
+
+// The nybblized tracks of a floppy, kept one by one so a forked machine or
+// a checkpoint can share them with the machine they came from.  A track in
+// use by more than one is copied by writableTrack() before it's changed.
+struct NybblizedTracks
+{
+    typedef std::array<uint8_t,nybblizedTrackSize> Track;
+    vector<shared_ptr<Track>> tracks;
+
+    int count() const { return tracks.size(); }
+    const uint8_t *track(int n) const { return tracks[n]->data(); }
+
+    uint8_t *writableTrack(int n)
+    {
+        if(tracks[n].use_count() > 1) {
+            tracks[n] = make_shared<Track>(*tracks[n]);
+        } else {
+            // See the other machine's last reads before writing
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return tracks[n]->data();
+    }
+
+    void assign(int count)
+    {
+        tracks.clear();
+        for(int i = 0; i < count; i++) {
+            tracks.push_back(make_shared<Track>()); // zero filled
+        }
+    }
+
+    void clear()
+    {
+        tracks.clear();
+    }
+};
+
+// Nybblize all of the tracks of a sector image, so moving the head to
+// another track only has to point at it
+void nybblizeFloppy(const uint8_t *floppyImage, size_t size, NybblizedTracks& nybblizedTracks, int& trackCount, const int *skew)
+{
+    constexpr size_t trackSize = sectorsPerTrack * sectorSize;
+
+    if(size % trackSize != 0) {
+        fprintf(stderr, "floppy disk image ends with a partial track of %zd bytes, ignored\n", size % trackSize);
+    }
+
+    trackCount = size / trackSize;
+    nybblizedTracks.assign(trackCount);
+    for(int trackIndex = 0; trackIndex < trackCount; trackIndex++) {
+        nybblizeTrack(floppyImage, trackIndex, nybblizedTracks.writableTrack(trackIndex), skew);
+    }
+}
 
-        uint8_t sectorBytes[256];
-        size_t wasRead = fread(sectorBytes, 1, sectorSize, floppyImageFile);
-        if(wasRead != sectorSize) {
-            fprintf(stderr, "failed to read sector from floppy disk image\n");
-            printf("track %d, sectorIndex %d, skew %d, offset %d, read %zd\n", trackIndex, sectorIndex, skew[sectorIndex], sectorOffset, wasRead);
+// ".nib" images hold the nybbles of each track as they are on the disk, in
+// tracks the same size as the ones nybblizeTrack() makes
+constexpr size_t nibTrackSize = 6656;
+static_assert(nibTrackSize == nybblizedTrackSize, ".nib tracks must fit the nybblized track buffers");
+
+// A track of a WOZ image, the bits on the disk starting with the high bit
+// of the first byte
+struct BitTrack
+{
+    const uint8_t *bits;
+    uint32_t bitCount; // 0 for no track
+};
+
+// Find the tracks in a WOZ 1 or 2 image and which track is under each
+// quarter-track head position.  The tracks point into the image.
+bool readWozImage(const uint8_t *image, size_t size, uint8_t quarterTrackMap[160], vector<BitTrack>& tracks, bool& writeProtected)
+{
+    auto le16 = [](const uint8_t *p) { return p[0] | (p[1] << 8); };
+    auto le32 = [](const uint8_t *p) { return uint32_t(p[0] | (p[1] << 8) | (p[2] << 16)) | (uint32_t(p[3]) << 24); };
+
+    if((size < 12) || (memcmp(image, "WOZ", 3) != 0) || ((image[3] != '1') && (image[3] != '2')) || (image[4] != 0xFF)) {
+        fprintf(stderr, "not a WOZ 1 or 2 image\n");
+        return false;
+    }
+    int version = image[3] - '0';
+
+    bool foundInfo = false, foundMap = false, foundTracks = false;
+    tracks.clear();
+    for(size_t offset = 12; offset + 8 <= size; ) {
+        const uint8_t *id = image + offset;
+        uint32_t chunkSize = le32(image + offset + 4);
+        const uint8_t *chunk = image + offset + 8;
+        if(chunkSize > size - offset - 8) {
+            fprintf(stderr, "WOZ image chunk runs past the end of the file\n");
             return false;
         }
 
-        uint8_t *sectorDest = nybblizedTrack + trackGapSize + sectorIndex * nybblizedSectorSize;
+        if((memcmp(id, "INFO", 4) == 0) && (chunkSize >= 3)) {
+            if(chunk[1] != 1) {
+                fprintf(stderr, "WOZ image isn't a 5.25 inch disk\n");
+                return false;
+            }
+            writeProtected = chunk[2] != 0;
+            foundInfo = true;
+        } else if((memcmp(id, "TMAP", 4) == 0) && (chunkSize >= 160)) {
+            memcpy(quarterTrackMap, chunk, 160);
+            foundMap = true;
+        } else if(memcmp(id, "TRKS", 4) == 0) {
+            if(version == 1) {
+                // Each track is 6646 bytes of bits then the bytes and bits used
+                for(size_t t = 0; (t + 1) * 6656 <= chunkSize; t++) {
+                    const uint8_t *track = chunk + t * 6656;
+                    uint32_t bitCount = le16(track + 6648);
+                    tracks.push_back({track, (bitCount <= 6646 * 8) ? bitCount : 0});
+                }
+            } else {
+                // 160 entries of starting 512-byte block, block count, and bit count
+                for(size_t t = 0; (t < 160) && ((t + 1) * 8 <= chunkSize); t++) {
+                    const uint8_t *entry = chunk + t * 8;
+                    size_t start = le16(entry) * size_t(512);
+                    uint32_t bitCount = le32(entry + 4);
+                    if((start == 0) || (start + (bitCount + 7) / 8 > size)) {
+                        tracks.push_back({nullptr, 0});
+                    } else {
+                        tracks.push_back({image + start, bitCount});
+                    }
+                }
+            }
+            foundTracks = true;
+        }
+        offset += 8 + chunkSize;
+    }
 
-        nybblizeSector(trackIndex, sectorIndex, sectorBytes, sectorDest);
+    if(!foundInfo || !foundMap || !foundTracks) {
+        fprintf(stderr, "WOZ image is missing its INFO, TMAP, or TRKS chunk\n");
+        return false;
     }
     return true;
 }
@@ -718,7 +1193,101 @@ int calculateMotorSnapLocation(int headLocation /* 0 to headDiscretePositions -
 
 };
 
-// XXX readonly at this time
+// Writes tracks and sectors back to floppy image files on a thread of its own, so the
+// emulator doesn't wait on the host's disk.  Writes to each file land in
+// the order they were queued.
+struct floppy_writer
+{
+    struct image_write
+    {
+        string name;
+        long offset;
+        vector<uint8_t> bytes;
+    };
+
+    std::mutex lock;
+    std::condition_variable work_waiting;
+    std::condition_variable work_done;
+    deque<image_write> queue;
+    bool writing = false;
+    bool quitting = false;
+    std::thread worker;
+
+    floppy_writer() : worker([this]{ run(); }) {}
+
+    ~floppy_writer()
+    {
+        {
+            std::unique_lock<std::mutex> l(lock);
+            quitting = true;
+        }
+        work_waiting.notify_one();
+        worker.join();
+    }
+
+    void enqueue(image_write&& w)
+    {
+        {
+            std::unique_lock<std::mutex> l(lock);
+            queue.push_back(std::move(w));
+        }
+        work_waiting.notify_one();
+    }
+
+    void wait_until_idle()
+    {
+        std::unique_lock<std::mutex> l(lock);
+        work_done.wait(l, [this]{ return queue.empty() && !writing; });
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> l(lock);
+        while(true) {
+            work_waiting.wait(l, [this]{ return quitting || !queue.empty(); });
+            if(queue.empty()) {
+                return;
+            }
+            deque<image_write> writes;
+            writes.swap(queue);
+            writing = true;
+            l.unlock();
+
+            FILE *fp = nullptr;
+            string fp_name;
+            for(const auto& w : writes) {
+                if(!fp || (fp_name != w.name)) {
+                    if(fp) {
+                        fclose(fp);
+                    }
+                    fp_name = w.name;
+                    fp = fopen(w.name.c_str(), "r+b");
+                    if(!fp) {
+                        fprintf(stderr, "failed to open floppy disk image \"%s\" for writing\n", w.name.c_str());
+                        continue;
+                    }
+                }
+                if((fseek(fp, w.offset, SEEK_SET) != 0) || (fwrite(w.bytes.data(), 1, w.bytes.size(), fp) != w.bytes.size())) {
+                    fprintf(stderr, "failed to write to floppy disk image \"%s\"\n", w.name.c_str());
+                }
+            }
+            if(fp) {
+                fclose(fp);
+            }
+
+            l.lock();
+            writing = false;
+            work_done.notify_all();
+        }
+    }
+};
+
+floppy_writer& get_floppy_writer()
+{
+    static floppy_writer writer;
+    return writer;
+}
+
 struct DISKIIboard : board_base
 {
     static constexpr int CA0 = 0xC0E0; // stepper phase 0 / control line 0
@@ -755,55 +1324,129 @@ struct DISKIIboard : board_base
 
     bool floppyPresent[2] = {false, false};
     std::string floppyImageNames[2];
-    FILE *floppyImageFiles[2] = {nullptr, nullptr};
     const int *floppySectorSkew[2] = {nullptr, nullptr};
+    DiskII::NybblizedTracks floppyNybblizedTracks[2]; // every track, nybblized at insertion
+    int floppyTrackCount[2] = {0, 0};
+    bool floppyWriteProtected[2] = {false, false}; // image file isn't writable
+    vector<bool> floppyTrackDirty[2]; // written since last flushed to the image
+
+    // Sector images are nybblized at insertion and .nib images are already
+    // nybbles; both go by a byte per read of Q6L.  WOZ images are bits read
+    // from the mapped file as the disk turns under the head; the mapping is
+    // shared with forks and checkpoints, whose bit tracks point into it too.
+    enum FloppyFormat {SECTORS, NYBBLES, BITS} floppyFormat[2] = {SECTORS, SECTORS};
+    shared_ptr<DiskII::MappedImage> floppyMappedImages[2];
+    uint8_t floppyQuarterTrackMaps[2][160];
+    vector<DiskII::BitTrack> floppyBitTracks[2];
+
+    // Written tracks go back to the image file when the drive motor turns
+    // off or the floppy is ejected.  Forked machines keep them in memory.
+    // With holdWrites, as while there are checkpoints to rewind to, they
+    // wait for the floppy to be ejected or the board to go away instead,
+    // so the image doesn't get writes a rewind could take back.
+    bool writeBack = true;
+    bool holdWrites = false;
+    clk_t lastWriteBack = 0; // CPU clock tracks were last queued for the image
 
     // Floppy drive control
     int driveSelected = 0;
     bool driveMotorEnabled[2] = {false, false};
     enum {READ, WRITE} headMode = READ;
+    bool latchLoad = false; // Q6; with READ, sense write protect
     uint8_t dataLatch = 0x00;
     DiskII::MagnetState driveMagnetState[2] = { {false, false, false, false}, {false, false, false, false} };
     int currentHeadLocation[2] = {0, 0}; // XXXFLOPPY normalize this to head location 0-(headDiscretePositions - 1)
 
-    // track data
-    uint8_t trackBytes[DiskII::nybblizedTrackSize];
+    // track data, pointing into floppyNybblizedTracks
+    const uint8_t *trackBytes = nullptr;
     bool trackBytesOutOfDate = true;
     int nybblizedTrackIndex = -1;
     int nybblizedDriveIndex = -1;
     uint32_t trackByteIndex = 0;
 
+    // WOZ read state: a bit passes under the head every 4 CPU cycles and
+    // shifts into the shifter from its first 1 bit; once 8 bits are in, the
+    // byte is latched and can be read for 2 more bit cells
+    static constexpr clk_t cyclesPerBit = 4;
+    const system_clock& clk;
+    clk_t bitClock = 0; // CPU clock the head reached bitIndex
+    uint32_t bitIndex[2] = {0, 0};
+    int bitTrackIndex[2] = {-1, -1}; // track bitIndex is on, to rescale when the head moves
+    uint8_t bitShifter = 0;
+    uint8_t bitLatch = 0;
+    uint32_t bitsSinceLatched = 0;
+
     void set_floppy(int number, const char *name) // number 0 or 1; name = NULL to eject
     {
+        flushFloppy(number);
         floppyPresent[number] = false;
         floppyImageNames[number] = "";
+        floppyNybblizedTracks[number].clear();
+        floppyTrackCount[number] = 0;
+        floppyTrackDirty[number].clear();
+        floppyFormat[number] = SECTORS;
+        floppyBitTracks[number].clear();
+        floppyMappedImages[number].reset();
+        bitTrackIndex[number] = -1;
         if(nybblizedDriveIndex == number) {
             nybblizedTrackIndex = -1;
             nybblizedDriveIndex = -1;
+            trackBytes = nullptr;
+            trackBytesOutOfDate = true;
         }
 
         if(name) {
-            if(floppyImageFiles[number]) {
-                fclose(floppyImageFiles[number]);
-            }
+            // The image may be this one or another drive's, with writes on the way
+            get_floppy_writer().wait_until_idle();
 
-            floppyImageFiles[number] = fopen(name, "rb");
+            floppyMappedImages[number] = make_shared<DiskII::MappedImage>();
+            DiskII::MappedImage& image = *floppyMappedImages[number];
 
-            if(!floppyImageFiles[number]) {
+            if(!image.open(name)) {
 
                 fprintf(stderr, "Couldn't open floppy disk image \"%s\"\n", name);
 
             } else {
 
-                if(strcmp(name + strlen(name) - 3, ".po") == 0) {
-                    printf("ProDOS floppy\n");
-                    floppySectorSkew[number] = DiskII::sectorSkewProDOS;
+                bool success = true;
+                floppyWriteProtected[number] = access(name, W_OK) != 0;
+
+                if(has_suffix(name, ".woz")) {
+                    floppyFormat[number] = BITS;
+                    bool wozWriteProtected = false;
+                    success = DiskII::readWozImage(image.data, image.size, floppyQuarterTrackMaps[number], floppyBitTracks[number], wozWriteProtected);
+                    floppyWriteProtected[number] = true; // Writing WOZ images isn't supported
+                } else if(has_suffix(name, ".nib")) {
+                    floppyFormat[number] = NYBBLES;
+                    if(image.size % DiskII::nibTrackSize != 0) {
+                        fprintf(stderr, "floppy disk image ends with a partial track of %zd bytes, ignored\n", image.size % DiskII::nibTrackSize);
+                    }
+                    floppyTrackCount[number] = image.size / DiskII::nibTrackSize;
+                    floppyNybblizedTracks[number].assign(floppyTrackCount[number]);
+                    for(int track = 0; track < floppyTrackCount[number]; track++) {
+                        const uint8_t *nibTrack = image.data + track * DiskII::nibTrackSize;
+                        std::copy(nibTrack, nibTrack + DiskII::nibTrackSize, floppyNybblizedTracks[number].writableTrack(track));
+                    }
                 } else {
-                    floppySectorSkew[number] = DiskII::sectorSkewDOS;
+                    if(has_suffix(name, ".po")) {
+                        printf("ProDOS floppy\n");
+                        floppySectorSkew[number] = DiskII::sectorSkewProDOS;
+                    } else {
+                        floppySectorSkew[number] = DiskII::sectorSkewDOS;
+                    }
+                    DiskII::nybblizeFloppy(image.data, image.size, floppyNybblizedTracks[number], floppyTrackCount[number], floppySectorSkew[number]);
                 }
 
-                floppyPresent[number] = true;
-                floppyImageNames[number] = name;
+                if(success) {
+                    floppyPresent[number] = true;
+                    floppyImageNames[number] = name;
+                    floppyTrackDirty[number].assign(floppyTrackCount[number], false);
+                } else {
+                    fprintf(stderr, "Couldn't read floppy disk image \"%s\"\n", name);
+                }
+                if(floppyFormat[number] != BITS) {
+                    floppyMappedImages[number].reset();
+                }
             }
         }
     }
@@ -811,10 +1454,11 @@ struct DISKIIboard : board_base
     typedef std::function<void (int number, bool activity)> floppy_activity_func;
     floppy_activity_func floppy_activity;
 
-    DISKIIboard(const uint8_t diskII_rom[256], const char *floppy0_name, const char *floppy1_name, floppy_activity_func floppy_activity_) :
+    DISKIIboard(const system_clock& clk_, const uint8_t diskII_rom[256], const char *floppy0_name, const char *floppy1_name, floppy_activity_func floppy_activity_) :
+        clk(clk_),
         floppy_activity(floppy_activity_)
     {
-        std::copy(diskII_rom, diskII_rom + 0x100, rom_C600.memory.begin());
+        rom_C600.memory.copy_in(diskII_rom, 0x100);
         if(floppy0_name) {
             set_floppy(0, floppy0_name);
         }
@@ -823,52 +1467,309 @@ struct DISKIIboard : board_base
         }
     }
 
-    uint8_t readNextTrackByte()
+    ~DISKIIboard()
     {
-        // bool dataValid = (headMode != READ || !driveMotorEnabled[driveSelected] || !floppyPresent[driveSelected]);
-        bool dataValid = floppyPresent[driveSelected];
-        if(!dataValid) {
-            return 0x00;
-        }
-
-        if(trackBytesOutOfDate) {
-            readDriveTrack();
-            trackBytesOutOfDate = false;
-        }
+        flushFloppies();
+    }
 
-        uint8_t data = trackBytes[trackByteIndex];
+    // The floppies in the drives as the machine sees them, writes not yet
+    // flushed to the images included, so another board can take them
+    // without reading the images again.  Tracks and mapped images are
+    // shared, not copied.
+    struct floppy_contents
+    {
+        bool present[2] = {false, false};
+        std::string imageNames[2];
+        const int *sectorSkew[2] = {nullptr, nullptr};
+        DiskII::NybblizedTracks nybblizedTracks[2];
+        int trackCount[2] = {0, 0};
+        bool writeProtected[2] = {false, false};
+        vector<bool> trackDirty[2];
+        FloppyFormat format[2] = {SECTORS, SECTORS};
+        shared_ptr<DiskII::MappedImage> mappedImages[2];
+        uint8_t quarterTrackMaps[2][160] = {};
+        vector<DiskII::BitTrack> bitTracks[2];
+    };
 
-        if(false) {
-            printf("read track %d byte %d (sector %ld byte %ld), yields %d (%02X)\n", nybblizedTrackIndex, trackByteIndex, trackByteIndex / DiskII::nybblizedSectorSize, trackByteIndex % DiskII::nybblizedSectorSize, data, data);
+    floppy_contents save_floppies() const
+    {
+        floppy_contents c;
+        for(int i = 0; i < 2; i++) {
+            c.present[i] = floppyPresent[i];
+            c.imageNames[i] = floppyImageNames[i];
+            c.sectorSkew[i] = floppySectorSkew[i];
+            c.nybblizedTracks[i] = floppyNybblizedTracks[i];
+            c.trackCount[i] = floppyTrackCount[i];
+            c.writeProtected[i] = floppyWriteProtected[i];
+            c.trackDirty[i] = floppyTrackDirty[i];
+            c.format[i] = floppyFormat[i];
+            c.mappedImages[i] = floppyMappedImages[i];
+            memcpy(c.quarterTrackMaps[i], floppyQuarterTrackMaps[i], sizeof(floppyQuarterTrackMaps[i]));
+            c.bitTracks[i] = floppyBitTracks[i];
         }
-
-        trackByteIndex = (trackByteIndex + 1) % DiskII::nybblizedTrackSize;
-
-        return data;
+        return c;
     }
 
-    bool readDriveTrack()
+    // Replaces the floppies without flushing them; follow with
+    // transfer_state() to put the heads back where they were
+    void restore_floppies(const floppy_contents& c)
     {
-        if(!floppyPresent[driveSelected]) {
-            return false;
+        for(int i = 0; i < 2; i++) {
+            floppyPresent[i] = c.present[i];
+            floppyImageNames[i] = c.imageNames[i];
+            floppySectorSkew[i] = c.sectorSkew[i];
+            floppyNybblizedTracks[i] = c.nybblizedTracks[i];
+            floppyTrackCount[i] = c.trackCount[i];
+            floppyWriteProtected[i] = c.writeProtected[i];
+            floppyTrackDirty[i] = c.trackDirty[i];
+            floppyFormat[i] = c.format[i];
+            floppyMappedImages[i] = c.mappedImages[i];
+            memcpy(floppyQuarterTrackMaps[i], c.quarterTrackMaps[i], sizeof(floppyQuarterTrackMaps[i]));
+            floppyBitTracks[i] = c.bitTracks[i];
+            bitTrackIndex[i] = -1;
         }
+        nybblizedTrackIndex = -1;
+        nybblizedDriveIndex = -1;
+        trackBytes = nullptr;
+        trackBytesOutOfDate = true;
+    }
 
-        if(currentHeadLocation[driveSelected] % 4 != 0) {
-            fprintf(stderr, "current head location %d was unexpectedly not aligned with Disk II track (%% 4 = %d)\n", currentHeadLocation[driveSelected], currentHeadLocation[driveSelected] % 4);
-            return true;
+    // Decode the tracks written since the last flush and queue their
+    // sectors for writing to the image
+    void flushFloppy(int number)
+    {
+        if(!floppyPresent[number]) {
+            return;
+        }
+        for(int track = 0; track < floppyTrackCount[number]; track++) {
+            if(!floppyTrackDirty[number][track]) {
+                continue;
+            }
+            floppyTrackDirty[number][track] = false;
+            if(!writeBack) {
+                continue;
+            }
+            lastWriteBack = clk.clock_cpu;
+
+            if(floppyFormat[number] == NYBBLES) {
+                floppy_writer::image_write w;
+                w.name = floppyImageNames[number];
+                w.offset = track * DiskII::nibTrackSize;
+                w.bytes.assign(nybblizedTrack(number, track), nybblizedTrack(number, track) + DiskII::nibTrackSize);
+                get_floppy_writer().enqueue(std::move(w));
+                continue;
+            }
+
+            uint8_t floppyTrack[DiskII::sectorsPerTrack * DiskII::sectorSize];
+            bool sectorValid[DiskII::sectorsPerTrack];
+            DiskII::denybblizeTrack(nybblizedTrack(number, track), track, floppyTrack, floppySectorSkew[number], sectorValid);
+            for(int sector = 0; sector < DiskII::sectorsPerTrack; sector++) {
+                if(!sectorValid[sector]) {
+                    if(debug & DEBUG_WARN) fprintf(stderr, "couldn't decode written track %d sector %d of \"%s\"\n", track, sector, floppyImageNames[number].c_str());
+                    continue;
+                }
+                floppy_writer::image_write w;
+                w.name = floppyImageNames[number];
+                w.offset = (track * DiskII::sectorsPerTrack + sector) * DiskII::sectorSize;
+                w.bytes.assign(floppyTrack + sector * DiskII::sectorSize, floppyTrack + (sector + 1) * DiskII::sectorSize);
+                get_floppy_writer().enqueue(std::move(w));
+            }
+        }
+    }
+
+    void flushFloppies()
+    {
+        flushFloppy(0);
+        flushFloppy(1);
+    }
+
+    void writeNextTrackByte(uint8_t data)
+    {
+        if(!floppyPresent[driveSelected] || floppyWriteProtected[driveSelected]) {
+            return;
+        }
+
+        if(trackBytesOutOfDate) {
+            readDriveTrack();
+            trackBytesOutOfDate = false;
+        }
+        if(!trackBytes) {
+            return;
+        }
+
+        // The track may be shared with a fork or a checkpoint
+        uint8_t *track = floppyNybblizedTracks[nybblizedDriveIndex].writableTrack(nybblizedTrackIndex);
+        trackBytes = track;
+        track[trackByteIndex] = data;
+        floppyTrackDirty[nybblizedDriveIndex][nybblizedTrackIndex] = true;
+
+        trackByteIndex = (trackByteIndex + 1) % DiskII::nybblizedTrackSize;
+    }
+
+    // Shift in the bits that passed under the head since the last read and
+    // return what the CPU would see in the data register
+    uint8_t readNextBits()
+    {
+        if(clk.clock_cpu < bitClock) {
+            bitClock = clk.clock_cpu; // the clock went back with a loaded state
+        }
+        clk_t bits = (clk.clock_cpu - bitClock) / cyclesPerBit;
+        bitClock += bits * cyclesPerBit;
+
+        int track = floppyQuarterTrackMaps[driveSelected][currentHeadLocation[driveSelected]];
+        if((track == 0xFF) || (track >= (int)floppyBitTracks[driveSelected].size()) || (floppyBitTracks[driveSelected][track].bitCount == 0)) {
+            // No track here; nothing but zeros, so nothing latches
+            bitShifter = 0;
+            bitsSinceLatched += bits;
+            return (bitsSinceLatched < 2) ? bitLatch : bitShifter;
+        }
+        const DiskII::BitTrack& bitTrack = floppyBitTracks[driveSelected][track];
+
+        uint32_t& index = bitIndex[driveSelected];
+        if(bitTrackIndex[driveSelected] != track) {
+            // Keep the same angle around the disk on the new track
+            if(bitTrackIndex[driveSelected] >= 0) {
+                uint32_t oldCount = floppyBitTracks[driveSelected][bitTrackIndex[driveSelected]].bitCount;
+                index = (oldCount > 0) ? uint64_t(index) * bitTrack.bitCount / oldCount : 0;
+            }
+            bitTrackIndex[driveSelected] = track;
+        }
+        index %= bitTrack.bitCount;
+
+        // Only the last few bits can matter after a long time between reads
+        if(bits > 16) {
+            index = (index + (bits - 16)) % bitTrack.bitCount;
+            bitsSinceLatched += bits - 16;
+            bits = 16;
+        }
+        for(clk_t i = 0; i < bits; i++) {
+            uint8_t bit = (bitTrack.bits[index / 8] >> (7 - index % 8)) & 1;
+            index = (index + 1) % bitTrack.bitCount;
+            bitShifter = (bitShifter << 1) | bit;
+            bitsSinceLatched++;
+            if(bitShifter & 0x80) {
+                bitLatch = bitShifter;
+                bitShifter = 0;
+                bitsSinceLatched = 0;
+            }
+        }
+        return (bitsSinceLatched < 2) ? bitLatch : bitShifter;
+    }
+
+    uint8_t readNextTrackByte()
+    {
+        // bool dataValid = (headMode != READ || !driveMotorEnabled[driveSelected] || !floppyPresent[driveSelected]);
+        bool dataValid = floppyPresent[driveSelected];
+        if(!dataValid) {
+            return 0x00;
+        }
+
+        if(floppyFormat[driveSelected] == BITS) {
+            return readNextBits();
+        }
+
+        if(trackBytesOutOfDate) {
+            readDriveTrack();
+            trackBytesOutOfDate = false;
+        }
+        if(!trackBytes) {
+            return 0x00;
+        }
+
+        uint8_t data = trackBytes[trackByteIndex];
+
+        if(false) {
+            printf("read track %d byte %d (sector %ld byte %ld), yields %d (%02X)\n", nybblizedTrackIndex, trackByteIndex, trackByteIndex / DiskII::nybblizedSectorSize, trackByteIndex % DiskII::nybblizedSectorSize, data, data);
+        }
+
+        trackByteIndex = (trackByteIndex + 1) % DiskII::nybblizedTrackSize;
+
+        return data;
+    }
+
+    // The track the next reads of Q6L would come from and where in it, so
+    // a whole field can be read at once; false if reads of the selected
+    // drive aren't simply the next bytes of a nybblized track
+    bool nextTrackBytes(const uint8_t*& track, uint32_t& index)
+    {
+        if(!floppyPresent[driveSelected] || !driveMotorEnabled[driveSelected] ||
+            (headMode != READ) || (floppyFormat[driveSelected] == BITS)) {
+            return false;
+        }
+        if(trackBytesOutOfDate) {
+            readDriveTrack();
+            trackBytesOutOfDate = false;
+        }
+        if(!trackBytes) {
+            return false;
+        }
+        track = trackBytes;
+        index = trackByteIndex;
+        return true;
+    }
+
+    // The 512 bytes of a ProDOS block as they are on a drive's nybblized
+    // tracks, writes not yet flushed included; false if the floppy isn't
+    // nybblized or either of the block's sectors doesn't decode
+    bool readBlock(int drive, int block, uint8_t *data) const
+    {
+        int track = block / 8;
+        if(!floppyPresent[drive] || (floppyFormat[drive] == BITS) || (track >= floppyTrackCount[drive])) {
+            return false;
+        }
+        // Decoding with ProDOS's skew puts the sectors in block order
+        // whatever order the image is in
+        uint8_t floppyTrack[DiskII::sectorsPerTrack * DiskII::sectorSize];
+        bool sectorValid[DiskII::sectorsPerTrack];
+        DiskII::denybblizeTrack(nybblizedTrack(drive, track), track, floppyTrack, DiskII::sectorSkewProDOS, sectorValid);
+        int sector = (block % 8) * 2;
+        if(!sectorValid[sector] || !sectorValid[sector + 1]) {
+            return false;
+        }
+        memcpy(data, floppyTrack + sector * DiskII::sectorSize, 2 * DiskII::sectorSize);
+        return true;
+    }
+
+    // As if count bytes had been read through Q6L
+    void skipTrackBytes(uint32_t count)
+    {
+        latchLoad = false;
+        trackByteIndex = (trackByteIndex + count) % DiskII::nybblizedTrackSize;
+    }
+
+    bool motorOn() const
+    {
+        return driveMotorEnabled[0] || driveMotorEnabled[1];
+    }
+
+    const uint8_t *nybblizedTrack(int drive, int track) const
+    {
+        return floppyNybblizedTracks[drive].track(track);
+    }
+
+    bool readDriveTrack()
+    {
+        if(!floppyPresent[driveSelected]) {
+            return false;
+        }
+
+        if(currentHeadLocation[driveSelected] % 4 != 0) {
+            fprintf(stderr, "current head location %d was unexpectedly not aligned with Disk II track (%% 4 = %d)\n", currentHeadLocation[driveSelected], currentHeadLocation[driveSelected] % 4);
+            return true;
         }
 
         if((nybblizedTrackIndex == currentHeadLocation[driveSelected]) && (nybblizedDriveIndex == driveSelected)) {
             return true;
         }
 
-        bool success = DiskII::nybblizeTrackFromFile(floppyImageFiles[driveSelected], currentHeadLocation[driveSelected] / 4, trackBytes, floppySectorSkew[driveSelected]);
-        if(!success) {
-            fprintf(stderr, "unexpected failure reading track from disk \"%s\"\n", floppyImageNames[driveSelected].c_str());
+        int track = currentHeadLocation[driveSelected] / 4;
+        if(track >= floppyTrackCount[driveSelected]) {
+            fprintf(stderr, "track %d is past the end of disk \"%s\"\n", track, floppyImageNames[driveSelected].c_str());
             return false;
         }
+        trackBytes = nybblizedTrack(driveSelected, track);
 
-        nybblizedTrackIndex = currentHeadLocation[driveSelected] / 4;
+        nybblizedTrackIndex = track;
         nybblizedDriveIndex = driveSelected;
         trackByteIndex = 0;
 
@@ -979,8 +1880,15 @@ struct DISKIIboard : board_base
     {
         if(addr < 0xC0E0 || addr > 0xC0EF)
             return false;
-        if(debug & DEBUG_WARN) printf("DISK II unhandled write of %02X to %04X (%s)\n", data, addr, io.at(addr).c_str());
-        return false;
+        // Switches change on writes as they do on reads, and a write to Q6H
+        // or Q7H also loads the byte to be written into the latch
+        uint8_t ignored;
+        read(addr, ignored);
+        if((addr == Q6H) || (addr == Q7H)) {
+            if(debug & DEBUG_FLOPPY) printf("floppy load latch : %02X\n", data);
+            dataLatch = data;
+        }
+        return true;
     }
 
     virtual bool read(int addr, uint8_t &data)
@@ -1000,18 +1908,26 @@ struct DISKIIboard : board_base
             data = 0;
             return true;
         } else if(addr == Q6L) { // 0xC0EC
-            data = readNextTrackByte();
-            if(debug & DEBUG_FLOPPY) printf("floppy read byte : %02X\n", data);
+            latchLoad = false;
+            if(headMode == WRITE) {
+                writeNextTrackByte(dataLatch);
+                if(debug & DEBUG_FLOPPY) printf("floppy write byte : %02X\n", dataLatch);
+                data = 0;
+            } else {
+                data = readNextTrackByte();
+                if(debug & DEBUG_FLOPPY) printf("floppy read byte : %02X\n", data);
+            }
             return true;
         } else if(addr == Q6H) { // 0xC0ED
             if(debug & DEBUG_FLOPPY) printf("floppy read latch\n");
-            data = dataLatch; // XXX do something with the latch - e.g. set write-protect bit
+            latchLoad = true;
             data = 0;
             return true;
         } else if(addr == Q7L) { // 0xC0EE
             if(debug & DEBUG_FLOPPY) printf("floppy set read\n");
             headMode = READ;
-            data = 0;
+            // Q6H then Q7L senses write protect in bit 7
+            data = (latchLoad && floppyWriteProtected[driveSelected]) ? 0x80 : 0x00;
             return true;
         } else if(addr == Q7H) { // 0xC0EF
             if(debug & DEBUG_FLOPPY) printf("floppy set write\n");
@@ -1038,6 +1954,9 @@ struct DISKIIboard : board_base
             if(debug & DEBUG_FLOPPY) printf("floppy switch off\n");
             driveMotorEnabled[driveSelected] = false;
             floppy_activity(driveSelected, false);
+            if(!holdWrites) {
+                flushFloppy(driveSelected);
+            }
             // go disable reading
             // disable other drive?
             data = 0;
@@ -1064,49 +1983,583 @@ struct DISKIIboard : board_base
         floppy_activity(0, false);
         floppy_activity(1, false);
     }
+
+    // Floppy images are saved by name and reinserted on load if they
+    // differ
+    template <class S>
+    void transfer_state(S& s)
+    {
+        for(int i = 0; i < 2; i++) {
+            string name = floppyImageNames[i];
+            s.text(name);
+            if(S::loading && s.ok && (name != floppyImageNames[i])) {
+                set_floppy(i, name.empty() ? NULL : name.c_str());
+            }
+        }
+        s.value(driveSelected);
+        s.value(driveMotorEnabled);
+        s.value(headMode);
+        s.value(latchLoad);
+        s.value(dataLatch);
+        s.value(driveMagnetState);
+        s.value(currentHeadLocation);
+        s.value(trackBytesOutOfDate);
+        s.value(nybblizedTrackIndex);
+        s.value(nybblizedDriveIndex);
+        s.value(trackByteIndex);
+        trackByteIndex %= DiskII::nybblizedTrackSize;
+        s.value(bitClock);
+        s.value(bitIndex);
+        s.value(bitTrackIndex);
+        s.value(bitShifter);
+        s.value(bitLatch);
+        s.value(bitsSinceLatched);
+
+        if(S::loading && s.ok) {
+            if((nybblizedDriveIndex >= 0) && (nybblizedDriveIndex <= 1) && floppyPresent[nybblizedDriveIndex] &&
+                (nybblizedTrackIndex >= 0) && (nybblizedTrackIndex < floppyTrackCount[nybblizedDriveIndex])) {
+                trackBytes = nybblizedTrack(nybblizedDriveIndex, nybblizedTrackIndex);
+            } else {
+                nybblizedTrackIndex = -1;
+                nybblizedDriveIndex = -1;
+                trackBytes = nullptr;
+                trackBytesOutOfDate = true;
+            }
+            for(int i = 0; i < 2; i++) {
+                if((bitTrackIndex[i] < -1) || (bitTrackIndex[i] >= (int)floppyBitTracks[i].size())) {
+                    bitTrackIndex[i] = -1;
+                }
+            }
+            floppy_activity(0, driveMotorEnabled[0]);
+            floppy_activity(1, driveMotorEnabled[1]);
+        }
+    }
+};
+
+const int audio_sample_rate = 44100;
+
+// A 6522 VIA's registers, ports, and timers.  The timers aren't counted
+// down cycle by cycle; their counts and interrupt flags are worked out
+// from the CPU clock they were loaded at whenever they're looked at.
+struct VIA6522
+{
+    enum {ORB, ORA, DDRB, DDRA, T1CL, T1CH, T1LL, T1LH, T2CL, T2CH, SR, ACR, PCR, IFR, IER, ORA_NH};
+    static constexpr uint8_t T1_FLAG = 0x40;
+    static constexpr uint8_t T2_FLAG = 0x20;
+    static constexpr uint8_t T1_FREE_RUN = 0x40; // in ACR
+    static constexpr clk_t never = std::numeric_limits<clk_t>::max();
+
+    uint8_t orb = 0, ora = 0, ddrb = 0, ddra = 0;
+    uint8_t sr = 0, acr = 0, pcr = 0, ifr = 0, ier = 0;
+    uint16_t t1_latch = 0xFFFF;
+    uint8_t t2_latch_low = 0xFF;
+    clk_t t1_loaded = 0, t2_loaded = 0; // CPU clock the counter was loaded
+    uint16_t t1_start = 0xFFFF, t2_start = 0xFFFF; // and what with
+    clk_t t1_next = never, t2_next = never; // next underflow to set a flag
+
+    uint8_t port_b() const { return (orb & ddrb) | ~ddrb; } // undriven inputs float high
+    uint8_t port_a() const { return (ora & ddra) | ~ddra; }
+
+    clk_t t1_period() const { return t1_latch + 2; }
+
+    // Set the flags of underflows up to now
+    void update(clk_t now)
+    {
+        if(now >= t1_next) {
+            ifr |= T1_FLAG;
+            if(acr & T1_FREE_RUN) {
+                t1_next += ((now - t1_next) / t1_period() + 1) * t1_period();
+            } else {
+                t1_next = never;
+            }
+        }
+        if(now >= t2_next) {
+            ifr |= T2_FLAG;
+            t2_next = never;
+        }
+    }
+
+    uint16_t t1_counter(clk_t now) const
+    {
+        clk_t elapsed = now - t1_loaded;
+        if((elapsed <= t1_start) || !(acr & T1_FREE_RUN)) {
+            return t1_start - elapsed;
+        }
+        clk_t k = (elapsed - t1_start - 1) % t1_period();
+        return (k == 0) ? 0xFFFF : (t1_latch - (k - 1));
+    }
+
+    uint16_t t2_counter(clk_t now) const
+    {
+        return t2_start - (now - t2_loaded);
+    }
+
+    bool interrupting() const
+    {
+        return (ifr & ier & 0x7F) != 0;
+    }
+
+    // The earliest clock IRQ might go low, if it isn't already
+    clk_t next_interrupt() const
+    {
+        clk_t next = never;
+        if(ier & T1_FLAG) {
+            next = std::min(next, t1_next);
+        }
+        if(ier & T2_FLAG) {
+            next = std::min(next, t2_next);
+        }
+        return next;
+    }
+
+    uint8_t read(int reg, clk_t now, uint8_t port_a_input)
+    {
+        update(now);
+        switch(reg) {
+            case ORB: return port_b();
+            case ORA: case ORA_NH: return (ora & ddra) | (port_a_input & ~ddra);
+            case DDRB: return ddrb;
+            case DDRA: return ddra;
+            case T1CL: ifr &= ~T1_FLAG; return t1_counter(now) & 0xFF;
+            case T1CH: return t1_counter(now) >> 8;
+            case T1LL: return t1_latch & 0xFF;
+            case T1LH: return t1_latch >> 8;
+            case T2CL: ifr &= ~T2_FLAG; return t2_counter(now) & 0xFF;
+            case T2CH: return t2_counter(now) >> 8;
+            case SR: return sr;
+            case ACR: return acr;
+            case PCR: return pcr;
+            case IFR: return ifr | (interrupting() ? 0x80 : 0);
+            case IER: return ier | 0x80;
+        }
+        return 0;
+    }
+
+    void write(int reg, uint8_t data, clk_t now)
+    {
+        update(now);
+        switch(reg) {
+            case ORB: orb = data; break;
+            case ORA: case ORA_NH: ora = data; break;
+            case DDRB: ddrb = data; break;
+            case DDRA: ddra = data; break;
+            case T1CL: case T1LL: t1_latch = (t1_latch & 0xFF00) | data; break;
+            case T1CH:
+                t1_latch = (t1_latch & 0x00FF) | (data << 8);
+                ifr &= ~T1_FLAG;
+                t1_loaded = now;
+                t1_start = t1_latch;
+                t1_next = now + t1_start + 1;
+                break;
+            case T1LH:
+                t1_latch = (t1_latch & 0x00FF) | (data << 8);
+                ifr &= ~T1_FLAG;
+                break;
+            case T2CL: t2_latch_low = data; break;
+            case T2CH:
+                ifr &= ~T2_FLAG;
+                t2_loaded = now;
+                t2_start = t2_latch_low | (data << 8);
+                t2_next = now + t2_start + 1;
+                break;
+            case SR: sr = data; break;
+            case ACR: acr = data; break;
+            case PCR: pcr = data; break;
+            case IFR: ifr &= ~(data & 0x7F); break;
+            case IER:
+                if(data & 0x80) {
+                    ier |= data & 0x7F;
+                } else {
+                    ier &= ~(data & 0x7F);
+                }
+                break;
+        }
+    }
+
+    void reset()
+    {
+        orb = ora = ddrb = ddra = 0;
+        sr = acr = pcr = ifr = ier = 0;
+        t1_next = t2_next = never;
+    }
+
+    template <class S>
+    void transfer_state(S& s)
+    {
+        s.value(orb); s.value(ora); s.value(ddrb); s.value(ddra);
+        s.value(sr); s.value(acr); s.value(pcr); s.value(ifr); s.value(ier);
+        s.value(t1_latch); s.value(t2_latch_low);
+        s.value(t1_loaded); s.value(t2_loaded);
+        s.value(t1_start); s.value(t2_start);
+        s.value(t1_next); s.value(t2_next);
+    }
+};
+
+// An AY-3-8910's tone, noise, and envelope generators, run a block of
+// output samples at a time: each generator's counter advances by the
+// PSG clocks in a sample and its output is taken once per sample, channel
+// by channel over the block.  Tones too high to hear play at half level,
+// as they average out to that.
+struct AY38910
+{
+    enum {TONE_A_FINE, TONE_A_COARSE, TONE_B_FINE, TONE_B_COARSE, TONE_C_FINE, TONE_C_COARSE,
+        NOISE_PERIOD, MIXER, LEVEL_A, LEVEL_B, LEVEL_C, ENVELOPE_FINE, ENVELOPE_COARSE,
+        ENVELOPE_SHAPE, PORT_A, PORT_B};
+    static constexpr uint8_t register_masks[16] = {
+        0xFF, 0x0F, 0xFF, 0x0F, 0xFF, 0x0F, 0x1F, 0xFF, 0x1F, 0x1F, 0x1F, 0xFF, 0xFF, 0x0F, 0xFF, 0xFF
+    };
+    static constexpr float levels[16] = {
+        0.0f, 0.0137f, 0.0205f, 0.0291f, 0.0423f, 0.0618f, 0.0847f, 0.1369f,
+        0.1691f, 0.2647f, 0.3527f, 0.4499f, 0.5704f, 0.6873f, 0.8482f, 1.0f,
+    };
+
+    uint8_t registers[16] = {};
+
+    float tone_counters[3] = {0, 0, 0}; // in PSG clocks
+    uint8_t tone_outputs[3] = {0, 0, 0};
+    float noise_counter = 0;
+    uint32_t noise_shifter = 1; // 17 bits
+    float envelope_counter = 0;
+    int envelope_step = 0; // 0 to 15 through a ramp
+    bool envelope_attack = false;
+    bool envelope_holding = false;
+
+    void reset()
+    {
+        std::fill(registers, registers + 16, 0);
+        envelope_step = 0;
+        envelope_attack = false;
+        envelope_holding = false;
+    }
+
+    void set_register(int reg, uint8_t data)
+    {
+        registers[reg] = data & register_masks[reg];
+        if(reg == ENVELOPE_SHAPE) {
+            envelope_counter = 0;
+            envelope_step = 0;
+            envelope_attack = data & 0x04;
+            envelope_holding = false;
+        }
+    }
+
+    int envelope_level() const
+    {
+        return envelope_attack ? envelope_step : (15 - envelope_step);
+    }
+
+    void advance_envelope()
+    {
+        if(envelope_holding || (++envelope_step < 16)) {
+            return;
+        }
+        uint8_t shape = registers[ENVELOPE_SHAPE];
+        bool cont = shape & 0x08, alternate = shape & 0x02, hold = shape & 0x01;
+        envelope_step = 15;
+        if(!cont) {
+            envelope_attack = false; // stays at 0
+            envelope_holding = true;
+        } else if(hold) {
+            if(alternate) {
+                envelope_attack = !envelope_attack;
+            }
+            envelope_holding = true;
+        } else {
+            envelope_step = 0;
+            if(alternate) {
+                envelope_attack = !envelope_attack;
+            }
+        }
+    }
+
+    static constexpr size_t block_size = 64;
+
+    // Add count samples at gain to out, clocks_per_sample PSG clocks apart
+    void render(float *out, size_t count, float clocks_per_sample, float gain)
+    {
+        while(count > block_size) {
+            render(out, block_size, clocks_per_sample, gain);
+            out += block_size;
+            count -= block_size;
+        }
+
+        uint8_t mixer = registers[MIXER];
+        float noise_outputs[block_size]; // 0 or 1
+        float envelope_levels[block_size];
+
+        float noise_period = 16 * std::max(1, (int)registers[NOISE_PERIOD]);
+        for(size_t i = 0; i < count; i++) {
+            noise_counter += clocks_per_sample;
+            while(noise_counter >= noise_period) {
+                noise_counter -= noise_period;
+                uint32_t bit = (noise_shifter ^ (noise_shifter >> 3)) & 1;
+                noise_shifter = (noise_shifter >> 1) | (bit << 16);
+            }
+            noise_outputs[i] = noise_shifter & 1;
+        }
+
+        float envelope_period = 16 * std::max(1, registers[ENVELOPE_FINE] + registers[ENVELOPE_COARSE] * 256);
+        for(size_t i = 0; i < count; i++) {
+            envelope_counter += clocks_per_sample;
+            while(envelope_counter >= envelope_period) {
+                envelope_counter -= envelope_period;
+                advance_envelope();
+            }
+            envelope_levels[i] = levels[envelope_level()] * gain;
+        }
+
+        for(int c = 0; c < 3; c++) {
+            uint8_t level = registers[LEVEL_A + c];
+            bool tone_off = mixer & (1 << c);
+            bool noise_off = mixer & (8 << c);
+            float half_period = 8 * std::max(1, registers[TONE_A_FINE + c * 2] + registers[TONE_A_COARSE + c * 2] * 256);
+            bool inaudible = half_period < clocks_per_sample;
+            const float *amplitudes = envelope_levels;
+            float fixed_amplitudes[block_size];
+            if(!(level & 0x10)) {
+                std::fill(fixed_amplitudes, fixed_amplitudes + count, levels[level & 0x0F] * gain);
+                amplitudes = fixed_amplitudes;
+            }
+            for(size_t i = 0; i < count; i++) {
+                tone_counters[c] += clocks_per_sample;
+                while(tone_counters[c] >= half_period) {
+                    tone_counters[c] -= half_period;
+                    tone_outputs[c] ^= 1;
+                }
+                float tone = tone_off ? 1.0f : (inaudible ? .5f : tone_outputs[c]);
+                float noise = noise_off ? 1.0f : noise_outputs[i];
+                out[i] += tone * noise * amplitudes[i];
+            }
+        }
+    }
 };
 
+constexpr uint8_t AY38910::register_masks[16];
+constexpr float AY38910::levels[16];
+
+// Two VIAs at $Cn00 and $Cn80, each with an AY-3-8910 on its ports: port A
+// is the PSG's data bus and port B bits 0-2 are BC1, BDIR, and /RESET.
+// Register writes are kept with their clocks until the main board asks
+// for samples, so the PSGs play them at the right sample.  The VIAs'
+// timers can interrupt the CPU; an event is scheduled for the next
+// underflow that could.
 struct Mockingboard : board_base
 {
-    Mockingboard()
+    typedef std::function<void ()> irq_changed_func;
+
+    const system_clock& clk;
+    event_scheduler& events;
+    irq_changed_func irq_changed;
+    scheduled_event timer_event;
+    bool interrupting = false;
+    VIA6522 vias[2];
+    AY38910 psgs[2];
+    uint8_t psg_registers[2][16] = {}; // as the CPU sees them
+    uint8_t psg_latched_register[2] = {0, 0};
+    uint8_t psg_output[2] = {0, 0}; // driven on port A by a PSG read
+
+    struct psg_write
+    {
+        clk_t clock; // 14MHz, as for the speaker
+        uint8_t psg;
+        uint8_t reg; // reset_all for a reset
+        uint8_t data;
+    };
+    static constexpr uint8_t reset_all = 0xFF;
+    vector<psg_write> psg_writes;
+
+    static constexpr float psg_clock_rate = machine_clock_rate * 65.0f / 912; // the CPU's average clock
+    static constexpr float channel_gain = .35f * 32767 / 3;
+
+    Mockingboard(const system_clock& clk_, event_scheduler& events_, irq_changed_func irq_changed_) :
+        clk(clk_),
+        events(events_),
+        irq_changed(irq_changed_)
+    {
+        timer_event.action = [this](){ update_interrupt(); };
+    }
+
+    virtual ~Mockingboard()
+    {
+        events.cancel(timer_event);
+    }
+
+    virtual bool owns_slot_io() { return false; }
+
+    // Strobing port B acts on the PSG according to BC1, BDIR, and /RESET
+    void psg_bus(int n)
+    {
+        uint8_t control = vias[n].port_b();
+        if(!(control & 0x04)) {
+            std::fill(psg_registers[n], psg_registers[n] + 16, 0);
+            psg_writes.push_back({(clk_t)clk, (uint8_t)n, reset_all, 0});
+            return;
+        }
+        switch(control & 0x03) {
+            case 1: // read
+                psg_output[n] = psg_registers[n][psg_latched_register[n]];
+                break;
+            case 2: { // write
+                uint8_t reg = psg_latched_register[n];
+                psg_registers[n][reg] = vias[n].port_a() & AY38910::register_masks[reg];
+                psg_writes.push_back({(clk_t)clk, (uint8_t)n, reg, vias[n].port_a()});
+                break;
+            }
+            case 3: // latch address
+                if(vias[n].port_a() < 16) {
+                    psg_latched_register[n] = vias[n].port_a();
+                }
+                break;
+        }
+    }
+
+    // Bring the timers up to now, tell the main board if IRQ changed, and
+    // wake up again at the next underflow that could pull IRQ low
+    void update_interrupt()
     {
+        vias[0].update(clk.clock_cpu);
+        vias[1].update(clk.clock_cpu);
+        bool was_interrupting = interrupting;
+        interrupting = vias[0].interrupting() || vias[1].interrupting();
+        if(interrupting) {
+            events.schedule(timer_event, scheduled_event::never);
+        } else {
+            events.schedule(timer_event, std::min(vias[0].next_interrupt(), vias[1].next_interrupt()));
+        }
+        if(interrupting != was_interrupting) {
+            irq_changed();
+        }
     }
 
     virtual bool write(int addr, uint8_t data)
     {
         if((addr >= 0xC400) && (addr <= 0xC4FF)) {
-            if(debug & DEBUG_RW) printf("Mockingboard write 0x%02X to 0x%04X ignored\n", data, addr);
+            int n = (addr & 0x80) ? 1 : 0;
+            int reg = addr & 0x0F;
+            if(debug & DEBUG_RW) printf("Mockingboard write 0x%02X to VIA %d register %d\n", data, n, reg);
+            vias[n].write(reg, data, clk.clock_cpu);
+            if(reg == VIA6522::ORB) {
+                psg_bus(n);
+            }
+            update_interrupt();
             return true;
         }
         return false;
     }
+
     virtual bool read(int addr, uint8_t &data)
     {
         if((addr >= 0xC400) && (addr <= 0xC4FF)) {
-            if(debug & DEBUG_RW) printf("Mockingboard read at 0x%04X ignored\n", addr);
-            data = 0;
+            int n = (addr & 0x80) ? 1 : 0;
+            data = vias[n].read(addr & 0x0F, clk.clock_cpu, psg_output[n]);
+            if(debug & DEBUG_RW) printf("Mockingboard read 0x%02X from VIA %d register %d\n", data, n, addr & 0x0F);
+            update_interrupt();
             return true;
         }
         return false;
     }
-    virtual void reset(void) {}
-};
-
-const int waveform_length = 44100 / 1000 / 2; // half of a wave at 4000 Hz
-const float waveform_max_amplitude = .35f;
-static uint8_t waveform[waveform_length];
 
-static void initialize_audio_waveform() __attribute__((constructor));
-void initialize_audio_waveform()
-{
-    for(int i = 0; i < waveform_length; i++) {
-        float theta = (float(i) / (waveform_length - 1) -.5f) * M_PI;
+    virtual bool board_get_interrupt(int& irq)
+    {
+        irq = 4;
+        return interrupting;
+    }
 
-        waveform[i] = 127.5 + waveform_max_amplitude * 127.5 * sin(theta);
+    virtual void reset(void)
+    {
+        for(int n = 0; n < 2; n++) {
+            vias[n].reset();
+            std::fill(psg_registers[n], psg_registers[n] + 16, 0);
+            psg_writes.push_back({(clk_t)clk, (uint8_t)n, reset_all, 0});
+        }
+        update_interrupt();
     }
-}
 
-int hires_blanking_address_base[262];
+    virtual void mix_audio(uint64_t first_sample, float *samples, size_t count)
+    {
+        static constexpr float clocks_per_sample = psg_clock_rate / audio_sample_rate;
+        size_t done = 0;
+        size_t applied = 0;
+        // Play up to the sample each write lands on, then make the write
+        for(; applied < psg_writes.size(); applied++) {
+            const psg_write& w = psg_writes[applied];
+            uint64_t at = w.clock * audio_sample_rate / machine_clock_rate;
+            if(at >= first_sample + count) {
+                break;
+            }
+            if(at > first_sample + done) {
+                size_t until = at - first_sample;
+                for(int n = 0; n < 2; n++) {
+                    psgs[n].render(samples + done, until - done, clocks_per_sample, channel_gain);
+                }
+                done = until;
+            }
+            if(w.reg == reset_all) {
+                psgs[w.psg].reset();
+            } else {
+                psgs[w.psg].set_register(w.reg, w.data);
+            }
+        }
+        psg_writes.erase(psg_writes.begin(), psg_writes.begin() + applied);
+        for(int n = 0; n < 2; n++) {
+            psgs[n].render(samples + done, count - done, clocks_per_sample, channel_gain);
+        }
+    }
+
+    template <class S>
+    void transfer_state(S& s)
+    {
+        for(int n = 0; n < 2; n++) {
+            vias[n].transfer_state(s);
+            s.value(psg_registers[n]);
+        }
+        s.value(psg_latched_register);
+        s.value(psg_output);
+        if(S::loading) {
+            psg_writes.clear();
+            for(int n = 0; n < 2; n++) {
+                psgs[n].reset();
+                for(int reg = 0; reg < 16; reg++) {
+                    psgs[n].set_register(reg, psg_registers[n][reg]);
+                }
+            }
+            interrupting = false;
+            update_interrupt();
+            irq_changed();
+        }
+    }
+};
+
+// Each speaker toggle is a step from one level to the other, mixed in as
+// a band-limited step: a windowed sinc impulse, picked for the fraction of
+// a sample the toggle landed at, added to deltas the output integrates.
+// Toggles falling between samples then don't alias.  Output is delayed
+// by half the impulse's length.
+const float speaker_amplitude = .35f * 32767;
+const int speaker_step_taps = 16;
+const int speaker_step_phases = 32;
+const float speaker_step_cutoff = .9f; // of the Nyquist frequency
+static float speaker_step_impulses[speaker_step_phases + 1][speaker_step_taps];
+
+static void initialize_speaker_steps() __attribute__((constructor));
+void initialize_speaker_steps()
+{
+    for(int phase = 0; phase <= speaker_step_phases; phase++) {
+        float sum = 0;
+        for(int i = 0; i < speaker_step_taps; i++) {
+            float x = i - (speaker_step_taps / 2 - 1) - float(phase) / speaker_step_phases;
+            float sinc = (x == 0) ? 1 : sin(M_PI * x * speaker_step_cutoff) / (M_PI * x * speaker_step_cutoff);
+            float window = .5f + .5f * cos(M_PI * x / (speaker_step_taps / 2));
+            speaker_step_impulses[phase][i] = sinc * window;
+            sum += sinc * window;
+        }
+        for(int i = 0; i < speaker_step_taps; i++) {
+            speaker_step_impulses[phase][i] /= sum;
+        }
+    }
+}
+
+int hires_blanking_address_base[262];
 extern const int hires_visible_address_base[262];
 
 static void generate_hires_scanout_addresses() __attribute__((constructor));
@@ -1220,6 +2673,13 @@ struct MAINboard : board_base
 
     vector<board_base*> boards;
 
+    // Cards by slot, and the cards answering each slot's I/O and ROM
+    // ranges, so accesses outside $C090-$CFFF never consult cards at all
+    std::array<board_base*,8> slots = {};
+    std::array<board_base*,8> slot_io_cards = {};
+    std::array<board_base*,8> slot_rom_cards = {};
+    board_base* expansion_rom_card = nullptr; // owns $C800-$CFFF until $CFFF accessed
+
     vector<SoftSwitch*> switches;
     SoftSwitch* switches_by_address[256];
     // Inside the Apple //e, page 379
@@ -1242,15 +2702,31 @@ struct MAINboard : board_base
     std::array<backed_region*,256> read_regions_by_page;
     std::array<backed_region*,256> write_regions_by_page;
 
-    void repage_regions(const char *reason)
+    // Host memory backing each 256-byte page, or nullptr if the page has
+    // no enabled region (the I/O page, for example), in which case
+    // read() and write() fall through to soft switches and peripherals.
+    std::array<uint8_t*,256> read_pages = {};
+    std::array<uint8_t*,256> write_pages = {};
+    // Incremented for a page when reads from it start coming from another
+    // region or stop being backed.  Not when the page is merely copied for
+    // copy-on-write, since it still holds the same bytes.
+    std::array<uint32_t,256> page_map_generations = {};
+
+    // Only rebuild the mapping for pages firstpage through lastpage,
+    // inclusive; regions not overlapping that range aren't consulted.
+    void repage_regions(const char *reason, int firstpage = 0x00, int lastpage = 0xFF)
     {
-        std::fill(read_regions_by_page.begin(), read_regions_by_page.end(), nullptr);
-        std::fill(write_regions_by_page.begin(), write_regions_by_page.end(), nullptr);
+        std::array<backed_region*,256> old_read_regions = read_regions_by_page;
+        std::fill(read_regions_by_page.begin() + firstpage, read_regions_by_page.begin() + lastpage + 1, nullptr);
+        std::fill(write_regions_by_page.begin() + firstpage, write_regions_by_page.begin() + lastpage + 1, nullptr);
         for(auto* r : regions) {
-            int firstpage = r->base / 256;
-            int lastpage = (r->base + r->size - 1) / 256;
+            int r_firstpage = std::max(firstpage, r->base / 256);
+            int r_lastpage = std::min(lastpage, (r->base + r->size - 1) / 256);
+            if(r_firstpage > r_lastpage) {
+                continue;
+            }
             if((r->type == RAM) && r->write_enabled()) {
-                for(int i = firstpage; i <= lastpage; i++) {
+                for(int i = r_firstpage; i <= r_lastpage; i++) {
                     if(write_regions_by_page[i]) {
                         if(false) {
                             printf("warning, write region for 0x%02X00 setting for \"%s\" but was already filled by \"%s\"; repaged because \"%s\"\n",
@@ -1262,7 +2738,7 @@ struct MAINboard : board_base
                 }
             }
             if(r->read_enabled()) {
-                for(int i = firstpage; i <= lastpage; i++) {
+                for(int i = r_firstpage; i <= r_lastpage; i++) {
                     if(read_regions_by_page[i]) {
                         if(false) {
                             printf("warning, read region for 0x%02X00 setting for \"%s\" but was already filled by \"%s\"; repaged because \"%s\"\n",
@@ -1274,6 +2750,84 @@ struct MAINboard : board_base
                 }
             }
         }
+        for(int i = firstpage; i <= lastpage; i++) {
+            uint8_t* old_read_page = read_pages[i];
+            backed_region* r = read_regions_by_page[i];
+            read_pages[i] = r ? const_cast<uint8_t*>(r->memory.page_data(i - r->base / 256)) : nullptr;
+            // Pages shared with a forked machine are copied by write() first
+            backed_region* w = write_regions_by_page[i];
+            bool writable = w && !w->memory.page_shared(i - w->base / 256);
+            write_pages[i] = writable ? w->memory.writable_page(i - w->base / 256) : nullptr;
+            // Pages owned by cards aren't backed here; read() and write() forward them
+            if(((i >= 0xC1) && (i <= 0xC7) && slot_rom_cards[i - 0xC0]) ||
+                ((i >= 0xC8) && (i <= 0xCF) && expansion_rom_card)) {
+                read_pages[i] = nullptr;
+                write_pages[i] = nullptr;
+            }
+            if((read_regions_by_page[i] != old_read_regions[i]) || ((read_pages[i] == nullptr) != (old_read_page == nullptr))) {
+                page_map_generations[i]++;
+            }
+        }
+    }
+
+    void install_card(int slot, board_base* card)
+    {
+        assert((slot >= 1) && (slot <= 7));
+        slots[slot] = card;
+        slot_io_cards[slot] = card->owns_slot_io() ? card : nullptr;
+        slot_rom_cards[slot] = card->owns_slot_rom() ? card : nullptr;
+        boards.push_back(card);
+        repage_regions("install card", 0xC0 + slot, 0xC0 + slot);
+        install_io_handlers();
+    }
+
+    // Deadlines for the main board's and cards' timed work, run between
+    // instructions by apple2e_instance::run_until()
+    event_scheduler events;
+
+    // Cards call irq_changed() when they start or stop pulling IRQ low, so
+    // the CPU only has to look at irq_line
+    bool irq_line = false;
+
+    void irq_changed()
+    {
+        irq_line = false;
+        for(auto b : boards) {
+            int irq;
+            irq_line = b->board_get_interrupt(irq) || irq_line;
+        }
+    }
+
+    bool irq_asserted()
+    {
+        return irq_line;
+    }
+
+    // A card's ROM space access selects its expansion ROM, if it has one
+    void select_expansion_rom(board_base* card)
+    {
+        board_base* selected = card->owns_expansion_rom() ? card : nullptr;
+        if(selected != expansion_rom_card) {
+            expansion_rom_card = selected;
+            repage_regions("select expansion ROM", 0xC8, 0xCF);
+        }
+    }
+
+    // Repage only the pages whose regions' enabled_funcs depend on sw
+    void repage_regions_for_switch(const SoftSwitch* sw, const char *reason)
+    {
+        if(sw == &ALTZP) {
+            repage_regions(reason, 0x00, 0x01);
+            repage_regions(reason, 0xD0, 0xFF);
+        } else if((sw == &RAMRD) || (sw == &RAMWRT)) {
+            repage_regions(reason, 0x02, 0xBF);
+        } else if((sw == &STORE80) || (sw == &PAGE2) || (sw == &HIRES)) {
+            repage_regions(reason, 0x04, 0x07);
+            repage_regions(reason, 0x20, 0x3F);
+        } else if((sw == &SLOTCXROM) || (sw == &C3ROM)) {
+            repage_regions(reason, 0xC1, 0xCF);
+        }
+        // TEXT, MIXED, ALTCHAR, and VID80 don't affect memory mapping
     }
 
     backed_region szp = {"szp", 0x0000, 0x0200, RAM, &regions, [&](){return !ALTZP;}}; // stack and zero page
@@ -1348,24 +2902,6 @@ struct MAINboard : board_base
         0xC062, // BUTN1 Solid Apple on and after Apple //e
     };
 
-    set<int> banking_read_switches = {
-        0xC080,
-        0xC081,
-        0xC082,
-        0xC083,
-        0xC084,
-        0xC085, 
-        0xC086,
-        0xC087,
-        0xC088,
-        0xC089,
-        0xC08A,
-        0xC08B,
-        0xC08C,
-        0xC08D,
-        0xC08E,
-        0xC08F,
-    };
     set<int> banking_write_switches = {
         0xC006,
         0xC007,
@@ -1383,14 +2919,22 @@ struct MAINboard : board_base
 
     deque<uint8_t> keyboard_buffer;
 
-    static const int sample_rate = 44100;
-    static const size_t audio_buffer_size = sample_rate / 100;
-    uint8_t audio_buffer[audio_buffer_size];
-    uint64_t audio_buffer_start_sample = 0;
-    uint64_t audio_buffer_next_sample = 0;
-    uint8_t speaker_level;
-    bool speaker_transitioning_to_high = false; 
-    int where_in_waveform = 0;
+    // Speaker toggles are only noted as they happen, and made into
+    // samples a block at a time, at least once a buffer's worth of cycles
+    static const size_t audio_buffer_size = audio_sample_rate / 100;
+    static const clk_t cycles_per_audio_buffer = (clk_t)machine_clock_rate * 65 / 912 / 100;
+    scheduled_event audio_event;
+    static const size_t max_speaker_toggles = 4096;
+    static const size_t speaker_delta_count = 32; // a power of two, at least speaker_step_taps
+    float audio_mix[audio_buffer_size]; // cards add theirs to the speaker's
+    int16_t audio_buffer[audio_buffer_size];
+    size_t audio_buffer_used = 0;
+    uint64_t audio_next_sample = 0; // the first sample not made yet
+    vector<clk_t> speaker_toggles; // since audio_next_sample
+    bool speaker_transitioning_to_high = false; // after the last toggle
+    float speaker_deltas[speaker_delta_count] = {}; // by sample number
+    float speaker_level = -speaker_amplitude;
+    float speaker_dc = -speaker_amplitude; // the speaker only passes changes
 
 #if LK_HACK
     uint8_t *disassemble_buffer = 0;
@@ -1400,25 +2944,53 @@ struct MAINboard : board_base
     int disassemble_addr = 0;
 #endif
 
-    void fill_flush_audio()
+    void make_audio_samples(uint64_t end)
     {
-        uint64_t current_sample = clk * sample_rate / machine_clock_rate;
-
-        for(uint64_t i = audio_buffer_next_sample; i < current_sample; i++) {
-            if(where_in_waveform < waveform_length) {
-                uint8_t level = waveform[where_in_waveform++];
-                speaker_level = speaker_transitioning_to_high ? level : (255 - level);
+        while(audio_next_sample < end) {
+            size_t count = std::min((uint64_t)(audio_buffer_size - audio_buffer_used), end - audio_next_sample);
+            float *mix = audio_mix + audio_buffer_used;
+            for(size_t i = 0; i < count; i++) {
+                float& delta = speaker_deltas[(audio_next_sample + i) % speaker_delta_count];
+                speaker_level += delta;
+                delta = 0;
+                mix[i] = speaker_level;
             }
-
-            audio_buffer[i % audio_buffer_size] = speaker_level;
-
-            if(i - audio_buffer_start_sample == audio_buffer_size - 1) {
+            for(auto b : boards) {
+                b->mix_audio(audio_next_sample, mix, count);
+            }
+            for(size_t i = 0; i < count; i++) {
+                speaker_dc += (mix[i] - speaker_dc) * (1.0f / 2048);
+                float sample = mix[i] - speaker_dc;
+                audio_buffer[audio_buffer_used + i] = std::max(-32768.0f, std::min(32767.0f, sample));
+            }
+            audio_buffer_used += count;
+            audio_next_sample += count;
+            if(audio_buffer_used == audio_buffer_size) {
                 audio_flush(audio_buffer, audio_buffer_size);
-
-                audio_buffer_start_sample = i + 1;
+                audio_buffer_used = 0;
+            }
+        }
+    }
+    void fill_flush_audio()
+    {
+        // The level before the first toggle not made into samples yet
+        bool high = speaker_transitioning_to_high ^ (speaker_toggles.size() % 2);
+
+        for(clk_t toggle : speaker_toggles) {
+            double when = double(toggle) * audio_sample_rate / machine_clock_rate;
+            uint64_t first = std::max((uint64_t)when, audio_next_sample);
+            make_audio_samples(first);
+            high = !high;
+            float step = high ? (2 * speaker_amplitude) : (-2 * speaker_amplitude);
+            int phase = std::min(std::max(int((when - first) * speaker_step_phases + .5), 0), speaker_step_phases);
+            const float *impulse = speaker_step_impulses[phase];
+            for(int i = 0; i < speaker_step_taps; i++) {
+                speaker_deltas[(first + i) % speaker_delta_count] += step * impulse[i];
             }
         }
-        audio_buffer_next_sample = current_sample;
+        speaker_toggles.clear();
+
+        make_audio_samples(clk * audio_sample_rate / machine_clock_rate);
     }
 
     clk_t open_apple_down_ends = 0;
@@ -1453,6 +3025,8 @@ struct MAINboard : board_base
         return APPLE2Einterface::ModeSettings(mode, MIXED, page, VID80, dhgr, ALTCHAR);
     }
 
+    // Display mode changes since the last frame, stamped with the CPU clock
+    APPLE2Einterface::ModeHistory mode_history;
     APPLE2Einterface::ModeSettings old_mode_settings;
     void post_soft_switch_mode_change()
     {
@@ -1463,27 +3037,29 @@ struct MAINboard : board_base
         }
     }
 
-    typedef std::function<bool (int addr, bool aux, uint8_t data)> display_write_func;
+    typedef std::function<bool (int addr, bool aux, uint8_t data, clk_t when)> display_write_func;
     display_write_func display_write;
-    typedef std::function<void (uint8_t *audiobuffer, size_t dist)> audio_flush_func;
+    typedef std::function<void (int16_t *audiobuffer, size_t dist)> audio_flush_func;
     audio_flush_func audio_flush;
     typedef std::function<tuple<float, bool> (int num)> get_paddle_func;
     get_paddle_func get_paddle;
-    clk_t paddles_clock_out[4];
+    clk_t paddles_clock_out[4] = {0, 0, 0, 0};
     MAINboard(system_clock& clk_, const uint8_t rom_image[32768],  display_write_func display_write_, audio_flush_func audio_flush_, get_paddle_func get_paddle_) :
         clk(clk_),
         internal_C800_ROM_selected(true),
-        speaker_level(waveform[0]),
         display_write(display_write_),
         audio_flush(audio_flush_),
         get_paddle(get_paddle_)
     {
-        std::copy(rom_image + rom_D000.base - 0x8000, rom_image + rom_D000.base - 0x8000 + rom_D000.size, rom_D000.memory.begin());
-        std::copy(rom_image + rom_E000.base - 0x8000, rom_image + rom_E000.base - 0x8000 + rom_E000.size, rom_E000.memory.begin());
-        std::copy(rom_image + rom_C100.base - 0x8000, rom_image + rom_C100.base - 0x8000 + rom_C100.size, rom_C100.memory.begin());
-        std::copy(rom_image + rom_C300.base - 0x8000, rom_image + rom_C300.base - 0x8000 + rom_C300.size, rom_C300.memory.begin());
-        std::copy(rom_image + rom_C400.base - 0x8000, rom_image + rom_C400.base - 0x8000 + rom_C400.size, rom_C400.memory.begin());
-        std::copy(rom_image + rom_C800.base - 0x8000, rom_image + rom_C800.base - 0x8000 + rom_C800.size, rom_C800.memory.begin());
+        // A fork passes no ROM image and shares its parent's memory instead
+        if(rom_image) {
+            rom_D000.memory.copy_in(rom_image + rom_D000.base - 0x8000, rom_D000.size);
+            rom_E000.memory.copy_in(rom_image + rom_E000.base - 0x8000, rom_E000.size);
+            rom_C100.memory.copy_in(rom_image + rom_C100.base - 0x8000, rom_C100.size);
+            rom_C300.memory.copy_in(rom_image + rom_C300.base - 0x8000, rom_C300.size);
+            rom_C400.memory.copy_in(rom_image + rom_C400.base - 0x8000, rom_C400.size);
+            rom_C800.memory.copy_in(rom_image + rom_C800.base - 0x8000, rom_C800.size);
+        }
 
         repage_regions("init");
 
@@ -1497,8 +3073,16 @@ struct MAINboard : board_base
             switches_by_address[sw->read_address - 0xC000] = sw;
         }
 
+        install_io_handlers();
+
         //  TEXT.enabled = true;
         old_mode_settings = convert_switches_to_mode_settings();
+
+        audio_event.action = [this](){
+            fill_flush_audio();
+            events.schedule(audio_event, clk.clock_cpu + cycles_per_audio_buffer);
+        };
+        events.schedule(audio_event, clk.clock_cpu + cycles_per_audio_buffer);
     }
 
     ~MAINboard()
@@ -1525,471 +3109,1705 @@ struct MAINboard : board_base
         }
     }
 
-    bool read(int addr, uint8_t &data)
+    static constexpr uint32_t max_saved_keys = 1 << 20;
+
+    // Everything that changes as the machine runs, except the CPU, the
+    // clock, and the cards' own state.  ROM isn't saved.
+    template <class S>
+    void transfer_state(S& s)
     {
-        if(debug & DEBUG_RW) printf("MAIN board read\n");
-        for(auto b : boards) {
-            if(b->read(addr, data)) {
-                return true;
-            }
+        for(auto sw : switches) {
+            s.value(sw->enabled);
         }
-        auto* r = read_regions_by_page[addr / 256];
-        if(r) {
-            data = r->memory[addr - r->base];
-            if(debug & DEBUG_RW) printf("read %02X from 0x%04X in %s\n", addr, data, r->name.c_str());
-                return true;
+        s.value(AN);
+        s.value(C08X_read_RAM);
+        s.value(C08X_write_RAM);
+        s.value(C08X_bank);
+        s.value(internal_C800_ROM_selected);
+
+        int expansion_rom_slot = 0;
+        for(int i = 1; i < 8; i++) {
+            if(expansion_rom_card && (slots[i] == expansion_rom_card)) {
+                expansion_rom_slot = i;
+            }
         }
-        if(io_region.contains(addr)) {
-            if(exit_on_banking && (banking_read_switches.find(addr) != banking_read_switches.end())) {
-                printf("bank switch control %04X, aborting\n", addr);
-                exit(1);
-            }
-            SoftSwitch* sw = switches_by_address[addr - 0xC000];
-            if(sw) {
-
-                uint8_t result = 0xFF;
-
-                // Special case for floating bus for reading video scanout 
-                // XXX doesn't handle 80-column nor AUX
-                if((addr == 0xC050) || (addr == 0xC051)) {
-                    bool page1 = (PAGE2 && !STORE80) ? false : true;
-
-                    // 65 bytes per line, 262 lines per frame (aka "field")
-                    int byte_in_frame = clk.clock_cpu % 17030;
-                    int line_in_frame = byte_in_frame / 65;
-
-                    if(0)printf("TEXT %s, HIRES %s, MIXED %s, line_in_frame = %d\n",
-                        TEXT ? "true" : "false",
-                        HIRES ? "true" : "false",
-                        MIXED ? "true" : "false",
-                        line_in_frame);
-
-                    bool mixed_text_scanout = 
-                        ((line_in_frame >= 160) && (line_in_frame < 192)) || 
-                        (line_in_frame >= 224);
-                    if(TEXT || !HIRES || (MIXED && mixed_text_scanout)) {
-                        // TEXT or GR mode; they read the same addresses.
-                        int addr2 = get_text_scanout_address(byte_in_frame) + (page1 ? 0 : 0x0400);
-                        if(0)printf("got text scanout address $%04X\n", addr2);
-                        if(addr2 > 0xC00) {
-                            if(0)printf("read 0C00 floating bus\n");
-                            ram_0C00.read(addr2, result);
-                        } else {
-                            if(page1) {
-                                if(0)printf("read text page1 floating bus\n");
-                                text_page1.read(addr2, result);
-                            } else {
-                                if(0)printf("read text page2 floating bus\n");
-                                text_page2.read(addr2, result);
-                            }
-                        }
-                    } else {
-                        // HGR mode and not in text region if MIXED
-                        int addr2 = get_hires_scanout_address(byte_in_frame) + (page1 ? 0 : 0x2000);
-                        if(0)printf("got hires scanout address $%04X\n", addr2);
-                        if(page1) {
-                            if(0)printf("read hires page1 floating bus\n");
-                            hires_page1.read(addr2, result);
-                        } else {
-                            if(0)printf("read hires page2 floating bus\n");
-                            hires_page2.read(addr2, result);
-                        }
-                    }
-                }
+        s.value(expansion_rom_slot);
 
-                if(addr == sw->read_address) {
-                    data = sw->enabled ? 0x80 : 0x00;
-                    if(debug & DEBUG_SWITCH) printf("Read status of %s = %02X\n", sw->name.c_str(), data);
-                    return true;
-                } else if(sw->read_also_changes && (addr == sw->set_address)) {
-                    if(!sw->implemented) { printf("%s ; set is unimplemented\n", sw->name.c_str()); fflush(stdout); exit(0); }
-                    data = result;
-                    if(!sw->enabled) {
-                        sw->enabled = true;
-                        if(debug & DEBUG_SWITCH) printf("Set %s\n", sw->name.c_str());
-                        post_soft_switch_mode_change();
-                        static char reason[512]; snprintf(reason, sizeof(reason), "set %s", sw->name.c_str());
-                        repage_regions(reason);
+        if(s.with_memory) {
+            for(auto r : regions) {
+                if(r->type == RAM) {
+                    for(size_t n = 0; n < r->memory.pages.size(); n++) {
+                        s.bytes(S::loading ? r->memory.writable_page(n) : const_cast<uint8_t*>(r->memory.page_data(n)), 256);
                     }
-                    return true;
-                } else if(sw->read_also_changes && (addr == sw->clear_address)) {
-                    if(!sw->implemented) { printf("%s ; unimplemented\n", sw->name.c_str()); fflush(stdout); exit(0); }
-                    data = result;
-                    if(sw->enabled) {
-                        sw->enabled = false;
-                        if(debug & DEBUG_SWITCH) printf("Clear %s\n", sw->name.c_str());
-                        post_soft_switch_mode_change();
-                        static char reason[512]; snprintf(reason, sizeof(reason), "clear %s", sw->name.c_str());
-                        repage_regions(reason);
-                    }
-                    return true;
-                }
-            }
-            if((addr & 0xFFF0) == 0xC080) {
-                C08X_bank = ((addr >> 3) & 1) ? BANK1 : BANK2;
-                C08X_write_RAM = addr & 1;
-                int read_ROM = ((addr >> 1) & 1) ^ C08X_write_RAM;
-                C08X_read_RAM = !read_ROM;
-                if(debug & DEBUG_SWITCH) printf("write %04X switch, %s, %d write_RAM, %d read_RAM\n", addr, (C08X_bank == BANK1) ? "BANK1" : "BANK2", C08X_write_RAM, C08X_read_RAM);
-                data = 0x00;
-                repage_regions("C08x write");
-                return true;
-            } else if(addr == 0xC011) {
-                data = (C08X_bank == BANK2) ? 0x80 : 0x0;
-                data = 0x00;
-                if(debug & DEBUG_SWITCH) printf("read BSRBANK2, return 0x%02X\n", data);
-                return true;
-            } else if(addr == 0xC012) {
-                data = C08X_read_RAM ? 0x80 : 0x0;
-                if(debug & DEBUG_SWITCH) printf("read BSRREADRAM, return 0x%02X\n", data);
-                return true;
-            } else if(addr == 0xC000) {
-                if(!keyboard_buffer.empty()) {
-                    data = 0x80 | keyboard_buffer[0];
-                } else {
-                    data = 0x00;
-                }
-                if(debug & DEBUG_RW) printf("read KBD, return 0x%02X\n", data);
-                return true;
-            } else if(addr == 0xC020) {
-                if(debug & DEBUG_RW) printf("read TAPE, force 0x00\n");
-                data = 0x00;
-                return true;
-            } else if(addr == 0xC030) {
-                if(debug & DEBUG_RW) printf("read SPKR, force 0x00\n");
-
-                fill_flush_audio();
-                data = 0x00;
-                where_in_waveform = 0;
-                speaker_transitioning_to_high = !speaker_transitioning_to_high;
-                return true;
-            } else if(addr == 0xC010) {
-                // reset keyboard latch
-                if(!keyboard_buffer.empty()) {
-                    keyboard_buffer.pop_front();
-                }
-                data = 0x0;
-                if(debug & DEBUG_RW) printf("read KBDSTRB, return 0x%02X\n", data);
-                return true;
-            } else if(addr == 0xC070) {
-                for(int i = 0; i < 4; i++) {
-                    float value;
-                    bool button;
-                    tie(value, button) = get_paddle(i);
-                    paddles_clock_out[i] = clk + value * paddle_max_pulse_seconds * machine_clock_rate;
                 }
-                data = 0x0;
-                return true;
-            } else if(addr >= 0xC064 && addr <= 0xC067) {
-                int num = addr - 0xC064;
-                data = (clk < paddles_clock_out[num]) ? 0xff : 0x00; 
-                return true;
-            } else if(addr >= 0xC061 && addr <= 0xC063) {
-                int num = addr - 0xC061;
-                if(num == 0 && (open_apple_down_ends > clk)) {
-                     data = 0xff;
-                     return true;
-                }
-                float value;
-                bool button;
-                tie(value, button) = get_paddle(num);
-                data = button ? 0xff : 0x0;
-                return true;
-            } else if(addr >= 0xC058 && addr <= 0xC05F) {
-                /* annunciators & DHGR enable */
-                int num = (addr - 0xC058) / 2;
-                bool set = addr & 1;
-                if(debug & DEBUG_RW) printf("read %04X, %s annunciator %d\n", addr, set ? "set" : "clear", num);
-                AN[num] = set;
-                // Should also do something here if we are emulating something attached to AN{0,1,2,3}
-                data = 0;
-                return true;
-            }
-            if(ignore_mmio.find(addr) != ignore_mmio.end()) {
-                if(debug & DEBUG_RW) printf("read %04X, ignored, return 0x00\n", addr);
-                data = 0x00;
-                return true;
-            }
-            if(MMIO_named_locations.count(addr) > 0) {
-                printf("unhandled MMIO Read at %04X (%s)\n", addr, MMIO_named_locations.at(addr).c_str());
-            } else {
-                printf("unhandled MMIO Read at %04X\n", addr);
-            }
-            data = 0x00;
-            return true;
-            // fflush(stdout); exit(0);
-        }
-        if((addr & 0xFF00) == 0xC300) {
-            if(debug & DEBUG_SWITCH) printf("read 0x%04X, enabling internal C800 ROM\n", addr);
-            if(!internal_C800_ROM_selected) {
-                internal_C800_ROM_selected = true;
-                repage_regions("C3xx write");
             }
         }
-        if(addr == 0xCFFF) {
-            if(debug & DEBUG_SWITCH) printf("read 0xCFFF, disabling internal C800 ROM\n");
-            if(internal_C800_ROM_selected) {
-                internal_C800_ROM_selected = false;
-                repage_regions("C3FF write");
+
+        uint32_t key_count = keyboard_buffer.size();
+        s.value(key_count);
+        if(S::loading) {
+            if(key_count > max_saved_keys) {
+                s.ok = false;
             }
+            keyboard_buffer.resize(s.ok ? key_count : 0);
         }
-        if(debug & DEBUG_WARN) printf("unhandled memory read at %04X\n", addr);
-        if(exit_on_memory_fallthrough) {
-            printf("unhandled memory read at %04X, aborting\n", addr);
-            printf("Switches:\n");
-            for(auto sw : switches) {
-                printf("    %s: %s\n", sw->name.c_str(), sw->enabled ? "enabled" : "disabled");
-            }
-            exit(1);
+        for(auto& key : keyboard_buffer) {
+            s.value(key);
         }
-        return false;
-    }
-    bool write(int addr, uint8_t data)
-    {
-#if LK_HACK
-        if(addr == 0xBFFE) {
-            // Reset protocol.
-            if (disassemble_buffer != 0) {
-                delete[] disassemble_buffer;
-                disassemble_buffer = 0;
-            }
-            disassemble_state = 0;
-            return true;
-        } else if (addr == 0xBFFF) {
-            // We dribble our meta-data in one byte at a time.
-            switch (disassemble_state) {
-                case 0:
-                    // LSB of size.
-                    disassemble_size = data;
-                    disassemble_state++;
-                    break;
 
-                case 1:
-                    // MSB of size.
-                    disassemble_size |= data << 8;
-                    disassemble_buffer = new uint8_t[disassemble_size];
-                    disassemble_index = 0;
-                    printf("Size of buffer: %d bytes\n", disassemble_size);
+        s.value(open_apple_down_ends);
+        s.value(paddles_clock_out);
+        s.value(speaker_transitioning_to_high);
 
-                    disassemble_state++;
-                    break;
+        if(S::loading && s.ok) {
+            expansion_rom_card = ((expansion_rom_slot >= 1) && (expansion_rom_slot <= 7)) ? slots[expansion_rom_slot] : nullptr;
+            repage_regions("load state");
+            irq_changed();
+            events.schedule(audio_event, clk.clock_cpu + cycles_per_audio_buffer);
 
-                case 2:
-                    // LSB of address.
-                    disassemble_addr = data;
-                    disassemble_state++;
-                    break;
+            // Don't make up audio for the time between the old and new clocks
+            audio_next_sample = clk * audio_sample_rate / machine_clock_rate;
+            speaker_toggles.clear();
+            std::fill(speaker_deltas, speaker_deltas + speaker_delta_count, 0.0f);
+            speaker_level = speaker_transitioning_to_high ? speaker_amplitude : -speaker_amplitude;
+            speaker_dc = speaker_level;
 
-                case 3:
-                    // MSB of address.
-                    disassemble_addr |= data << 8;
-                    disassemble_state++;
-                    break;
+            old_mode_settings = convert_switches_to_mode_settings();
+            mode_history.clear();
+            mode_history.push_back(make_tuple(clk.clock_cpu, old_mode_settings));
+            refresh_display();
+        }
+    }
 
-                case 4:
-                    // Add byte to disassembly buffer. Disassemble if full.
-                    if (disassemble_buffer != 0) {
-                        disassemble_buffer[disassemble_index++] = data;
+    // Use the same memory pages as parent, both sides copying a page when
+    // they first write to it
+    void share_memory(MAINboard& parent)
+    {
+        for(size_t i = 0; i < regions.size(); i++) {
+            regions[i]->memory.share(parent.regions[i]->memory);
+        }
+        repage_regions("share memory");
+        parent.repage_regions("share memory");
+    }
 
-                        if (disassemble_index == disassemble_size) {
-                            int bytes;
-                            string dis;
-                            for (int i = 0; i < disassemble_size;
-                                    i += bytes, disassemble_addr += bytes) {
+    // Share this board's memory pages into a checkpoint.  Each page is
+    // copied the first time it's written afterwards, so the checkpoint
+    // holds only the pages that changed after it.
+    void checkpoint_memory(vector<paged_memory>& memory)
+    {
+        memory.clear();
+        for(auto* r : regions) {
+            memory.push_back(r->memory);
+        }
+        repage_regions("checkpoint");
+    }
 
-                                tie(bytes, dis) = disassemble_6502(disassemble_addr,
-                                        disassemble_buffer + i);
+    void restore_memory(const vector<paged_memory>& memory)
+    {
+        for(size_t i = 0; i < regions.size(); i++) {
+            regions[i]->memory.share(memory[i]);
+        }
+        repage_regions("restore checkpoint");
+    }
 
-                                printf("%-32s", dis.c_str());
-                                if (bytes == 3) {
-                                    // Print function name if we have it.
-                                    int jump_address = disassemble_buffer[i + 1] +
-                                        (disassemble_buffer[i + 2] << 8);
-                                    auto search = address_to_function_name.find(jump_address);
-                                    if (search != address_to_function_name.end()) {
-                                        printf(" ; %s", search->second.c_str());
-                                    }
-                                }
-                                printf("\n");
-                            }
-                            printf("---\n");
-                            delete[] disassemble_buffer;
-                            disassemble_buffer = 0;
-                        }
-                    }
-                    break;
+    // Send the display every byte of the video pages, for when they were
+    // changed without going through write()
+    void refresh_display()
+    {
+        const std::pair<backed_region*, bool> video_pages[] = {
+            {&text_page1, false}, {&text_page1x, true}, {&text_page2, false}, {&text_page2x, true},
+            {&hires_page1, false}, {&hires_page1x, true}, {&hires_page2, false}, {&hires_page2x, true},
+        };
+        for(auto& page : video_pages) {
+            for(int i = 0; i < page.first->size; i++) {
+                display_write(page.first->base + i, page.second, page.first->memory[i], clk.clock_cpu);
             }
-            return true;
         }
-#endif
-        if((addr >= 0x400) && (addr <= 0xBFF)) {
-            display_write(addr, write_to_aux_text1(), data);
+    }
+
+    // Handlers for each address in the I/O page, $C000-$C0FF, filled in
+    // by install_io_handlers() so an I/O access is a single indexed call
+    typedef bool (MAINboard::*io_read_handler)(int addr, uint8_t &data);
+    typedef bool (MAINboard::*io_write_handler)(int addr, uint8_t data);
+    std::array<io_read_handler,256> io_read_handlers;
+    std::array<io_write_handler,256> io_write_handlers;
+
+    void install_io_handlers()
+    {
+        std::fill(io_read_handlers.begin(), io_read_handlers.end(), &MAINboard::read_unhandled_io);
+        std::fill(io_write_handlers.begin(), io_write_handlers.end(), &MAINboard::write_unhandled_io);
+
+        for(int addr : ignore_mmio) {
+            io_read_handlers[addr - 0xC000] = &MAINboard::read_ignored_io;
         }
-        if((addr >= 0x2000) && (addr <= 0x5FFF)) {
-            display_write(addr, write_to_aux_hires1(), data);
+
+        // Later assignments override earlier ones, so these are in reverse
+        // order of precedence
+        for(int addr = 0xC058; addr <= 0xC05F; addr++) {
+            io_read_handlers[addr - 0xC000] = &MAINboard::read_annunciator;
+            io_write_handlers[addr - 0xC000] = &MAINboard::write_annunciator;
         }
-        for(auto b : boards) { 
-            if(b->write(addr, data)) {
-                return true;
-            }
+        for(int addr = 0xC061; addr <= 0xC063; addr++) {
+            io_read_handlers[addr - 0xC000] = &MAINboard::read_button;
         }
-        auto* r = write_regions_by_page[addr / 256];
-        if(r) {
-            if(debug & DEBUG_RW) printf("wrote %02X to 0x%04X in %s\n", addr, data, r->name.c_str());
-            if((addr - r->base < 0) || (addr - r->base > r->size)) {
-                printf("write to %d outside region \"%s\", base %d, size %d\n", addr, r->name.c_str(), r->base, r->size);
-            }
-            r->memory[addr - r->base] = data;
-            return true;
+        for(int addr = 0xC064; addr <= 0xC067; addr++) {
+            io_read_handlers[addr - 0xC000] = &MAINboard::read_paddle;
         }
-        if(io_region.contains(addr)) {
-            if(exit_on_banking && (banking_write_switches.find(addr) != banking_write_switches.end())) {
-                printf("bank switch control %04X, exiting\n", addr);
-                exit(1);
-            }
-            SoftSwitch* sw = switches_by_address[addr - 0xC000];
-            if(sw) {
-                if(addr == sw->set_address) {
-                    if(!sw->implemented) { printf("%s ; set is unimplemented\n", sw->name.c_str()); fflush(stdout); exit(0); }
-                    data = 0xff;
-                    if(!sw->enabled) {
-                        sw->enabled = true;
-                        if(debug & DEBUG_SWITCH) printf("Set %s\n", sw->name.c_str());
-                        post_soft_switch_mode_change();
-                        static char reason[512]; snprintf(reason, sizeof(reason), "set %s", sw->name.c_str());
-                        repage_regions(reason);
-                    }
-                    return true;
-                } else if(addr == sw->clear_address) {
-                    // if(!sw->implemented) { printf("%s ; unimplemented\n", sw->name.c_str()); fflush(stdout); exit(0); }
-                    data = 0xff;
-                    if(sw->enabled) {
-                        sw->enabled = false;
-                        if(debug & DEBUG_SWITCH) printf("Clear %s\n", sw->name.c_str());
-                        post_soft_switch_mode_change();
-                        static char reason[512]; snprintf(reason, sizeof(reason), "clear %s", sw->name.c_str());
-                        repage_regions(reason);
-                    }
-                    return true;
+        io_read_handlers[0xC070 - 0xC000] = &MAINboard::read_paddle_trigger;
+        io_read_handlers[0xC010 - 0xC000] = &MAINboard::read_keyboard_strobe;
+        io_write_handlers[0xC010 - 0xC000] = &MAINboard::write_keyboard_strobe;
+        io_read_handlers[0xC030 - 0xC000] = &MAINboard::read_speaker;
+        io_write_handlers[0xC030 - 0xC000] = &MAINboard::write_speaker;
+        io_read_handlers[0xC020 - 0xC000] = &MAINboard::read_tape;
+        io_read_handlers[0xC000 - 0xC000] = &MAINboard::read_keyboard;
+        io_read_handlers[0xC012 - 0xC000] = &MAINboard::read_BSRREADRAM;
+        io_read_handlers[0xC011 - 0xC000] = &MAINboard::read_BSRBANK2;
+        for(int addr = 0xC080; addr <= 0xC08F; addr++) {
+            io_read_handlers[addr - 0xC000] = &MAINboard::read_C08X;
+            io_write_handlers[addr - 0xC000] = &MAINboard::write_C08X;
+        }
+
+        for(int slot = 1; slot <= 7; slot++) {
+            if(slot_io_cards[slot]) {
+                for(int addr = 0xC080 + slot * 16; addr <= 0xC08F + slot * 16; addr++) {
+                    io_read_handlers[addr - 0xC000] = &MAINboard::read_slot_io;
+                    io_write_handlers[addr - 0xC000] = &MAINboard::write_slot_io;
                 }
             }
-            if((addr & 0xFFF0) == 0xC080) {
-                C08X_bank = ((addr >> 3) & 1) ? BANK1 : BANK2;
-                C08X_write_RAM = addr & 1;
-                int read_ROM = ((addr >> 1) & 1) ^ C08X_write_RAM;
-                C08X_read_RAM = !read_ROM;
-                if(debug & DEBUG_SWITCH) printf("write %04X switch, %s, %d write_RAM, %d read_RAM\n", addr, (C08X_bank == BANK1) ? "BANK1" : "BANK2", C08X_write_RAM, C08X_read_RAM);
-                data = 0x00;
-                repage_regions("C08x write");
-                return true;
+        }
+
+        for(auto sw : switches) {
+            io_read_handlers[sw->read_address - 0xC000] = &MAINboard::read_switch_status;
+            if(sw->read_also_changes) {
+                io_read_handlers[sw->set_address - 0xC000] = &MAINboard::read_switch_set;
+                io_read_handlers[sw->clear_address - 0xC000] = &MAINboard::read_switch_clear;
             }
-            if(addr == 0xC010) {
-                if(debug & DEBUG_RW) printf("write KBDSTRB\n");
-                if(!keyboard_buffer.empty()) {
-                    keyboard_buffer.pop_front();
+            io_write_handlers[sw->set_address - 0xC000] = &MAINboard::write_switch_set;
+            io_write_handlers[sw->clear_address - 0xC000] = &MAINboard::write_switch_clear;
+        }
+    }
+
+    // Special case for floating bus for reading video scanout 
+    // XXX doesn't handle 80-column nor AUX
+    uint8_t read_floating_bus()
+    {
+        uint8_t result = 0xFF;
+
+        bool page1 = (PAGE2 && !STORE80) ? false : true;
+
+        // 65 bytes per line, 262 lines per frame (aka "field")
+        int byte_in_frame = clk.clock_cpu % 17030;
+        int line_in_frame = byte_in_frame / 65;
+
+        if(0)printf("TEXT %s, HIRES %s, MIXED %s, line_in_frame = %d\n",
+            TEXT ? "true" : "false",
+            HIRES ? "true" : "false",
+            MIXED ? "true" : "false",
+            line_in_frame);
+
+        bool mixed_text_scanout = 
+            ((line_in_frame >= 160) && (line_in_frame < 192)) || 
+            (line_in_frame >= 224);
+        if(TEXT || !HIRES || (MIXED && mixed_text_scanout)) {
+            // TEXT or GR mode; they read the same addresses.
+            int addr2 = get_text_scanout_address(byte_in_frame) + (page1 ? 0 : 0x0400);
+            if(0)printf("got text scanout address $%04X\n", addr2);
+            if(addr2 > 0xC00) {
+                if(0)printf("read 0C00 floating bus\n");
+                ram_0C00.read(addr2, result);
+            } else {
+                if(page1) {
+                    if(0)printf("read text page1 floating bus\n");
+                    text_page1.read(addr2, result);
+                } else {
+                    if(0)printf("read text page2 floating bus\n");
+                    text_page2.read(addr2, result);
                 }
-                // reset keyboard latch
-                return true;
-            }
-            if(addr == 0xC030) {
-                if(debug & DEBUG_RW) printf("write SPKR\n");
-                fill_flush_audio();
-                data = 0x00;
-                where_in_waveform = 0;
-                speaker_transitioning_to_high = !speaker_transitioning_to_high;
-                return true;
-            }
-            if(addr >= 0xC058 && addr <= 0xC05F) {
-                /* annunciators & DHGR enable */
-                int num = (addr - 0xC058) / 2;
-                bool set = addr & 1;
-                if(debug & DEBUG_RW) printf("write %04X, %s annunciator %d\n", addr, set ? "set" : "clear", num);
-                AN[num] = set;
-                // Should also do something here if we are emulating something attached to AN{0,1,2,3}
-                return true;
             }
-            if(MMIO_named_locations.count(addr) > 0) {
-                printf("unhandled MMIO Write at %04X (%s)\n", addr, MMIO_named_locations.at(addr).c_str());
+        } else {
+            // HGR mode and not in text region if MIXED
+            int addr2 = get_hires_scanout_address(byte_in_frame) + (page1 ? 0 : 0x2000);
+            if(0)printf("got hires scanout address $%04X\n", addr2);
+            if(page1) {
+                if(0)printf("read hires page1 floating bus\n");
+                hires_page1.read(addr2, result);
             } else {
-                printf("unhandled MMIO Write at %04X\n", addr);
+                if(0)printf("read hires page2 floating bus\n");
+                hires_page2.read(addr2, result);
             }
-            return false;
-            // fflush(stdout); exit(0);
         }
-        if(debug & DEBUG_WARN) printf("unhandled memory write to %04X\n", addr);
-        if(exit_on_memory_fallthrough) {
-            printf("unhandled memory write to %04X, exiting\n", addr);
+        return result;
+    }
+
+    bool read_switch_status(int addr, uint8_t &data)
+    {
+        SoftSwitch* sw = switches_by_address[addr - 0xC000];
+        data = sw->enabled ? 0x80 : 0x00;
+        if(debug & DEBUG_SWITCH) printf("Read status of %s = %02X\n", sw->name.c_str(), data);
+        return true;
+    }
+
+    bool read_switch_set(int addr, uint8_t &data)
+    {
+        SoftSwitch* sw = switches_by_address[addr - 0xC000];
+        if(!sw->implemented) { printf("%s ; set is unimplemented\n", sw->name.c_str()); fflush(stdout); exit(0); }
+        data = ((addr == 0xC050) || (addr == 0xC051)) ? read_floating_bus() : 0xFF;
+        if(!sw->enabled) {
+            sw->enabled = true;
+            if(debug & DEBUG_SWITCH) printf("Set %s\n", sw->name.c_str());
+            post_soft_switch_mode_change();
+            char reason[512]; snprintf(reason, sizeof(reason), "set %s", sw->name.c_str());
+            repage_regions_for_switch(sw, reason);
+        }
+        return true;
+    }
+
+    bool read_switch_clear(int addr, uint8_t &data)
+    {
+        SoftSwitch* sw = switches_by_address[addr - 0xC000];
+        if(!sw->implemented) { printf("%s ; unimplemented\n", sw->name.c_str()); fflush(stdout); exit(0); }
+        data = ((addr == 0xC050) || (addr == 0xC051)) ? read_floating_bus() : 0xFF;
+        if(sw->enabled) {
+            sw->enabled = false;
+            if(debug & DEBUG_SWITCH) printf("Clear %s\n", sw->name.c_str());
+            post_soft_switch_mode_change();
+            char reason[512]; snprintf(reason, sizeof(reason), "clear %s", sw->name.c_str());
+            repage_regions_for_switch(sw, reason);
+        }
+        return true;
+    }
+
+    void set_C08X(int addr)
+    {
+        C08X_bank = ((addr >> 3) & 1) ? BANK1 : BANK2;
+        C08X_write_RAM = addr & 1;
+        int read_ROM = ((addr >> 1) & 1) ^ C08X_write_RAM;
+        C08X_read_RAM = !read_ROM;
+        if(debug & DEBUG_SWITCH) printf("write %04X switch, %s, %d write_RAM, %d read_RAM\n", addr, (C08X_bank == BANK1) ? "BANK1" : "BANK2", C08X_write_RAM, C08X_read_RAM);
+        repage_regions("C08x write", 0xD0, 0xFF);
+    }
+
+    bool read_C08X(int addr, uint8_t &data)
+    {
+        if(exit_on_banking) {
+            printf("bank switch control %04X, aborting\n", addr);
+            exit(1);
+        }
+        set_C08X(addr);
+        data = 0x00;
+        return true;
+    }
+
+    bool read_BSRBANK2(int addr, uint8_t &data)
+    {
+        data = (C08X_bank == BANK2) ? 0x80 : 0x0;
+        data = 0x00;
+        if(debug & DEBUG_SWITCH) printf("read BSRBANK2, return 0x%02X\n", data);
+        return true;
+    }
+
+    bool read_BSRREADRAM(int addr, uint8_t &data)
+    {
+        data = C08X_read_RAM ? 0x80 : 0x0;
+        if(debug & DEBUG_SWITCH) printf("read BSRREADRAM, return 0x%02X\n", data);
+        return true;
+    }
+
+    bool read_keyboard(int addr, uint8_t &data)
+    {
+        if(!keyboard_buffer.empty()) {
+            data = 0x80 | keyboard_buffer[0];
+        } else {
+            data = 0x00;
+        }
+        if(debug & DEBUG_RW) printf("read KBD, return 0x%02X\n", data);
+        return true;
+    }
+
+    bool read_tape(int addr, uint8_t &data)
+    {
+        if(debug & DEBUG_RW) printf("read TAPE, force 0x00\n");
+        data = 0x00;
+        return true;
+    }
+
+    void toggle_speaker()
+    {
+        speaker_toggles.push_back(clk);
+        speaker_transitioning_to_high = !speaker_transitioning_to_high;
+        if(speaker_toggles.size() >= max_speaker_toggles) {
+            fill_flush_audio();
+        }
+    }
+
+    bool read_speaker(int addr, uint8_t &data)
+    {
+        if(debug & DEBUG_RW) printf("read SPKR, force 0x00\n");
+        toggle_speaker();
+        data = 0x00;
+        return true;
+    }
+
+    bool read_keyboard_strobe(int addr, uint8_t &data)
+    {
+        // reset keyboard latch
+        if(!keyboard_buffer.empty()) {
+            keyboard_buffer.pop_front();
+        }
+        data = 0x0;
+        if(debug & DEBUG_RW) printf("read KBDSTRB, return 0x%02X\n", data);
+        return true;
+    }
+
+    bool read_paddle_trigger(int addr, uint8_t &data)
+    {
+        for(int i = 0; i < 4; i++) {
+            float value;
+            bool button;
+            tie(value, button) = get_paddle(i);
+            paddles_clock_out[i] = clk + value * paddle_max_pulse_seconds * machine_clock_rate;
+        }
+        data = 0x0;
+        return true;
+    }
+
+    bool read_paddle(int addr, uint8_t &data)
+    {
+        int num = addr - 0xC064;
+        data = (clk < paddles_clock_out[num]) ? 0xff : 0x00; 
+        return true;
+    }
+
+    bool read_button(int addr, uint8_t &data)
+    {
+        int num = addr - 0xC061;
+        if(num == 0 && (open_apple_down_ends > clk)) {
+             data = 0xff;
+             return true;
+        }
+        float value;
+        bool button;
+        tie(value, button) = get_paddle(num);
+        data = button ? 0xff : 0x0;
+        return true;
+    }
+
+    bool read_annunciator(int addr, uint8_t &data)
+    {
+        /* annunciators & DHGR enable */
+        int num = (addr - 0xC058) / 2;
+        bool set = addr & 1;
+        if(debug & DEBUG_RW) printf("read %04X, %s annunciator %d\n", addr, set ? "set" : "clear", num);
+        AN[num] = set;
+        // Should also do something here if we are emulating something attached to AN{0,1,2,3}
+        data = 0;
+        return true;
+    }
+
+    bool read_slot_io(int addr, uint8_t &data)
+    {
+        if(slot_io_cards[(addr - 0xC080) / 16]->read(addr, data)) {
+            return true;
+        }
+        return read_unhandled_io(addr, data);
+    }
+
+    bool read_ignored_io(int addr, uint8_t &data)
+    {
+        if(debug & DEBUG_RW) printf("read %04X, ignored, return 0x00\n", addr);
+        data = 0x00;
+        return true;
+    }
+
+    bool read_unhandled_io(int addr, uint8_t &data)
+    {
+        if(MMIO_named_locations.count(addr) > 0) {
+            printf("unhandled MMIO Read at %04X (%s)\n", addr, MMIO_named_locations.at(addr).c_str());
+        } else {
+            printf("unhandled MMIO Read at %04X\n", addr);
+        }
+        data = 0x00;
+        return true;
+        // fflush(stdout); exit(0);
+    }
+
+    bool write_switch_set(int addr, uint8_t data)
+    {
+        if(exit_on_banking && (banking_write_switches.find(addr) != banking_write_switches.end())) {
+            printf("bank switch control %04X, exiting\n", addr);
+            exit(1);
+        }
+        SoftSwitch* sw = switches_by_address[addr - 0xC000];
+        if(!sw->implemented) { printf("%s ; set is unimplemented\n", sw->name.c_str()); fflush(stdout); exit(0); }
+        if(!sw->enabled) {
+            sw->enabled = true;
+            if(debug & DEBUG_SWITCH) printf("Set %s\n", sw->name.c_str());
+            post_soft_switch_mode_change();
+            char reason[512]; snprintf(reason, sizeof(reason), "set %s", sw->name.c_str());
+            repage_regions_for_switch(sw, reason);
+        }
+        return true;
+    }
+
+    bool write_switch_clear(int addr, uint8_t data)
+    {
+        if(exit_on_banking && (banking_write_switches.find(addr) != banking_write_switches.end())) {
+            printf("bank switch control %04X, exiting\n", addr);
             exit(1);
         }
-        return false;
+        SoftSwitch* sw = switches_by_address[addr - 0xC000];
+        // if(!sw->implemented) { printf("%s ; unimplemented\n", sw->name.c_str()); fflush(stdout); exit(0); }
+        if(sw->enabled) {
+            sw->enabled = false;
+            if(debug & DEBUG_SWITCH) printf("Clear %s\n", sw->name.c_str());
+            post_soft_switch_mode_change();
+            char reason[512]; snprintf(reason, sizeof(reason), "clear %s", sw->name.c_str());
+            repage_regions_for_switch(sw, reason);
+        }
+        return true;
+    }
+
+    bool write_C08X(int addr, uint8_t data)
+    {
+        set_C08X(addr);
+        return true;
+    }
+
+    bool write_keyboard_strobe(int addr, uint8_t data)
+    {
+        if(debug & DEBUG_RW) printf("write KBDSTRB\n");
+        // reset keyboard latch
+        if(!keyboard_buffer.empty()) {
+            keyboard_buffer.pop_front();
+        }
+        return true;
+    }
+
+    bool write_speaker(int addr, uint8_t data)
+    {
+        if(debug & DEBUG_RW) printf("write SPKR\n");
+        toggle_speaker();
+        return true;
+    }
+
+    bool write_slot_io(int addr, uint8_t data)
+    {
+        if(slot_io_cards[(addr - 0xC080) / 16]->write(addr, data)) {
+            return true;
+        }
+        return write_unhandled_io(addr, data);
+    }
+
+    bool write_annunciator(int addr, uint8_t data)
+    {
+        /* annunciators & DHGR enable */
+        int num = (addr - 0xC058) / 2;
+        bool set = addr & 1;
+        if(debug & DEBUG_RW) printf("write %04X, %s annunciator %d\n", addr, set ? "set" : "clear", num);
+        AN[num] = set;
+        // Should also do something here if we are emulating something attached to AN{0,1,2,3}
+        return true;
+    }
+
+    bool write_unhandled_io(int addr, uint8_t data)
+    {
+        if(MMIO_named_locations.count(addr) > 0) {
+            printf("unhandled MMIO Write at %04X (%s)\n", addr, MMIO_named_locations.at(addr).c_str());
+        } else {
+            printf("unhandled MMIO Write at %04X\n", addr);
+        }
+        return false;
+        // fflush(stdout); exit(0);
+    }
+
+    // Card owning a $C100-$CFFF address not mapped by read_pages or write_pages
+    board_base* card_for_address(int addr)
+    {
+        if((addr >= 0xC100) && (addr <= 0xC7FF)) {
+            board_base* card = slot_rom_cards[(addr >> 8) & 0x7];
+            if(card) {
+                select_expansion_rom(card);
+            }
+            return card;
+        }
+        if((addr >= 0xC800) && (addr <= 0xCFFF) && expansion_rom_card) {
+            board_base* card = expansion_rom_card;
+            if(addr == 0xCFFF) {
+                expansion_rom_card = nullptr;
+                repage_regions("CFFF deselects expansion ROM", 0xC8, 0xCF);
+            }
+            return card;
+        }
+        return nullptr;
+    }
+
+    // Read without side effects, for dumps and headless run conditions;
+    // anything not backed by memory reads as 0
+    uint8_t peek(int addr) const
+    {
+        uint8_t* page = read_pages[addr / 256];
+        return page ? page[addr % 256] : 0;
+    }
+
+    bool read(int addr, uint8_t &data)
+    {
+        if(debug & DEBUG_RW) printf("MAIN board read\n");
+        uint8_t* page = read_pages[addr / 256];
+        if(page) {
+            data = page[addr % 256];
+            if(debug & DEBUG_RW) printf("read %02X from 0x%04X in %s\n", addr, data, read_regions_by_page[addr / 256]->name.c_str());
+            return true;
+        }
+        if(io_region.contains(addr)) {
+            return (this->*io_read_handlers[addr - 0xC000])(addr, data);
+        }
+        if(board_base* card = card_for_address(addr)) {
+            if(card->read(addr, data)) {
+                return true;
+            }
+        }
+        if((addr & 0xFF00) == 0xC300) {
+            if(debug & DEBUG_SWITCH) printf("read 0x%04X, enabling internal C800 ROM\n", addr);
+            if(!internal_C800_ROM_selected) {
+                internal_C800_ROM_selected = true;
+                repage_regions("C3xx write", 0xC8, 0xCF);
+            }
+        }
+        if(addr == 0xCFFF) {
+            if(debug & DEBUG_SWITCH) printf("read 0xCFFF, disabling internal C800 ROM\n");
+            if(internal_C800_ROM_selected) {
+                internal_C800_ROM_selected = false;
+                repage_regions("C3FF write", 0xC8, 0xCF);
+            }
+        }
+        if(debug & DEBUG_WARN) printf("unhandled memory read at %04X\n", addr);
+        if(exit_on_memory_fallthrough) {
+            printf("unhandled memory read at %04X, aborting\n", addr);
+            printf("Switches:\n");
+            for(auto sw : switches) {
+                printf("    %s: %s\n", sw->name.c_str(), sw->enabled ? "enabled" : "disabled");
+            }
+            exit(1);
+        }
+        return false;
+    }
+    bool write(int addr, uint8_t data)
+    {
+#if LK_HACK
+        if(addr == 0xBFFE) {
+            // Reset protocol.
+            if (disassemble_buffer != 0) {
+                delete[] disassemble_buffer;
+                disassemble_buffer = 0;
+            }
+            disassemble_state = 0;
+            return true;
+        } else if (addr == 0xBFFF) {
+            // We dribble our meta-data in one byte at a time.
+            switch (disassemble_state) {
+                case 0:
+                    // LSB of size.
+                    disassemble_size = data;
+                    disassemble_state++;
+                    break;
+
+                case 1:
+                    // MSB of size.
+                    disassemble_size |= data << 8;
+                    disassemble_buffer = new uint8_t[disassemble_size];
+                    disassemble_index = 0;
+                    printf("Size of buffer: %d bytes\n", disassemble_size);
+
+                    disassemble_state++;
+                    break;
+
+                case 2:
+                    // LSB of address.
+                    disassemble_addr = data;
+                    disassemble_state++;
+                    break;
+
+                case 3:
+                    // MSB of address.
+                    disassemble_addr |= data << 8;
+                    disassemble_state++;
+                    break;
+
+                case 4:
+                    // Add byte to disassembly buffer. Disassemble if full.
+                    if (disassemble_buffer != 0) {
+                        disassemble_buffer[disassemble_index++] = data;
+
+                        if (disassemble_index == disassemble_size) {
+                            int bytes;
+                            string dis;
+                            for (int i = 0; i < disassemble_size;
+                                    i += bytes, disassemble_addr += bytes) {
+
+                                tie(bytes, dis) = disassemble_6502(disassemble_addr,
+                                        disassemble_buffer + i);
+
+                                printf("%-32s", dis.c_str());
+                                if (bytes == 3) {
+                                    // Print function name if we have it.
+                                    int jump_address = disassemble_buffer[i + 1] +
+                                        (disassemble_buffer[i + 2] << 8);
+                                    auto search = address_to_function_name.find(jump_address);
+                                    if (search != address_to_function_name.end()) {
+                                        printf(" ; %s", search->second.c_str());
+                                    }
+                                }
+                                printf("\n");
+                            }
+                            printf("---\n");
+                            delete[] disassemble_buffer;
+                            disassemble_buffer = 0;
+                        }
+                    }
+                    break;
+            }
+            return true;
+        }
+#endif
+        if((addr >= 0x400) && (addr <= 0xBFF)) {
+            display_write(addr, write_to_aux_text1(), data, clk.clock_cpu);
+        }
+        if((addr >= 0x2000) && (addr <= 0x5FFF)) {
+            display_write(addr, write_to_aux_hires1(), data, clk.clock_cpu);
+        }
+        uint8_t* page = write_pages[addr / 256];
+        if(page) {
+            if(debug & DEBUG_RW) printf("wrote %02X to 0x%04X in %s\n", addr, data, write_regions_by_page[addr / 256]->name.c_str());
+            page[addr % 256] = data;
+            return true;
+        }
+        if(backed_region* r = write_regions_by_page[addr / 256]) {
+            // Shared with a forked machine, so take a copy of the page
+            r->memory.set(addr - r->base, data);
+            repage_regions("copy on write", addr / 256, addr / 256);
+            return true;
+        }
+        if(io_region.contains(addr)) {
+            return (this->*io_write_handlers[addr - 0xC000])(addr, data);
+        }
+        if(board_base* card = card_for_address(addr)) {
+            if(card->write(addr, data)) {
+                return true;
+            }
+        }
+        if(debug & DEBUG_WARN) printf("unhandled memory write to %04X\n", addr);
+        if(exit_on_memory_fallthrough) {
+            printf("unhandled memory write to %04X, exiting\n", addr);
+            exit(1);
+        }
+        return false;
+    }
+};
+
+std::map<uint16_t, std::string> MAINboard::MMIO_named_locations =
+{
+    {0xC068, "STATEREG"},
+    {0xC05C, "CLRAN2"},
+    {0xC05E, "CLRAN3"},
+    {0xC05F, "SETAN3"},
+};
+
+struct bus_frontend
+{
+    MAINboard* board;
+    map<int, vector<uint8_t> > writes;
+    map<int, vector<uint8_t> > reads;
+
+    uint8_t read(uint16_t addr)
+    {
+        uint8_t data = 0xaa;
+        if(board->read(addr & 0xFFFF, data)) {
+            if(debug & DEBUG_BUS)
+            {
+                printf("R %04X %02X\n", addr & 0xFFFF, data);
+            }
+            // reads[addr & 0xFFFF].push_back(data);
+            return data;
+        }
+        if(debug & DEBUG_ERROR) {
+            fprintf(stderr, "no ownership of read at %04X\n", addr & 0xFFFF);
+        }
+        return 0xAA;
+    }
+    void write(uint16_t addr, uint8_t data)
+    {
+        if(board->write(addr & 0xFFFF, data)) {
+            if(debug & DEBUG_BUS)
+            {
+                printf("W %04X %02X\n", addr & 0xFFFF, data);
+            }
+            // writes[addr & 0xFFFF].push_back(data);
+            return;
+        }
+        if(debug & DEBUG_ERROR) {
+            fprintf(stderr, "no ownership of write %02X at %04X\n", data, addr & 0xFFFF);
+        }
+    }
+
+    uint32_t page_map_generation(int page)
+    {
+        return board->page_map_generations[page];
+    }
+
+    uint8_t** read_page_table()
+    {
+        return board->read_pages.data();
+    }
+
+    bool irq_asserted()
+    {
+        return board->irq_asserted();
+    }
+
+    // Events are run between instructions once the clock reaches their
+    // deadlines; earliest may be a little early, never late
+    uint64_t cycles_until_event()
+    {
+        clk_t earliest = board->events.earliest;
+        return (earliest > board->clk.clock_cpu) ? (earliest - board->clk.clock_cpu) : 0;
+    }
+
+    void reset()
+    {
+        board->reset();
+    }
+};
+
+// An input from outside the machine, stamped with the CPU clock it arrived
+// at.  Recordings hold one per line as text:
+//     CLOCK key CODE
+//     CLOCK paddle NUMBER VALUE BUTTON    (only when a paddle read changes)
+//     CLOCK reset
+//     CLOCK reboot
+//     CLOCK insert DRIVE FILENAME
+//     CLOCK eject DRIVE
+//     CLOCK load-state FILENAME
+//     CLOCK end                           (when recording stopped)
+struct input_event
+{
+    enum Type {KEY, PADDLE, RESET, REBOOT, INSERT_FLOPPY, EJECT_FLOPPY, LOAD_STATE, END};
+    clk_t clock;
+    Type type;
+    int number; // key code, paddle, or drive
+    float value; // paddle position
+    bool button; // paddle button
+    string name; // floppy or state filename
+
+    input_event(clk_t clock_, Type type_, int number_ = 0, const char *name_ = "") :
+        clock(clock_),
+        type(type_),
+        number(number_),
+        value(0),
+        button(false),
+        name(name_)
+    {}
+};
+
+void write_input_event(FILE *fp, const input_event& e)
+{
+    unsigned long long clock = e.clock;
+    switch(e.type) {
+        case input_event::KEY: fprintf(fp, "%llu key %d\n", clock, e.number); break;
+        case input_event::PADDLE: fprintf(fp, "%llu paddle %d %.9g %d\n", clock, e.number, e.value, e.button ? 1 : 0); break;
+        case input_event::RESET: fprintf(fp, "%llu reset\n", clock); break;
+        case input_event::REBOOT: fprintf(fp, "%llu reboot\n", clock); break;
+        case input_event::INSERT_FLOPPY: fprintf(fp, "%llu insert %d %s\n", clock, e.number, e.name.c_str()); break;
+        case input_event::EJECT_FLOPPY: fprintf(fp, "%llu eject %d\n", clock, e.number); break;
+        case input_event::LOAD_STATE: fprintf(fp, "%llu load-state %s\n", clock, e.name.c_str()); break;
+        case input_event::END: fprintf(fp, "%llu end\n", clock); break;
+    }
+    fflush(fp);
+}
+
+bool read_input_events(const char *name, deque<input_event>& events)
+{
+    FILE *fp = fopen(name, "r");
+    if(fp == NULL) {
+        fprintf(stderr, "failed to open %s for reading\n", name);
+        return false;
+    }
+    char line[1024];
+    int line_number = 0;
+    while(fgets(line, sizeof(line), fp) != NULL) {
+        line_number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        unsigned long long clock;
+        char type[32];
+        int used = 0;
+        if(sscanf(line, "%llu %31s %n", &clock, type, &used) < 2) {
+            fprintf(stderr, "%s:%d: expected a clock and an input\n", name, line_number);
+            fclose(fp);
+            return false;
+        }
+        const char *args = line + used;
+        input_event e(clock, input_event::END);
+        int button = 0;
+        bool valid = true;
+        if(strcmp(type, "key") == 0) {
+            e.type = input_event::KEY;
+            valid = sscanf(args, "%d", &e.number) == 1;
+        } else if(strcmp(type, "paddle") == 0) {
+            e.type = input_event::PADDLE;
+            valid = (sscanf(args, "%d %f %d", &e.number, &e.value, &button) == 3) && (e.number >= 0) && (e.number <= 3);
+            e.button = button;
+        } else if(strcmp(type, "reset") == 0) {
+            e.type = input_event::RESET;
+        } else if(strcmp(type, "reboot") == 0) {
+            e.type = input_event::REBOOT;
+        } else if((strcmp(type, "insert") == 0) || (strcmp(type, "load-state") == 0)) {
+            int name_offset = 0;
+            if(strcmp(type, "insert") == 0) {
+                e.type = input_event::INSERT_FLOPPY;
+                valid = sscanf(args, "%d %n", &e.number, &name_offset) == 1;
+            } else {
+                e.type = input_event::LOAD_STATE;
+            }
+            e.name = args + name_offset;
+            valid = valid && !e.name.empty();
+        } else if(strcmp(type, "eject") == 0) {
+            e.type = input_event::EJECT_FLOPPY;
+            valid = sscanf(args, "%d", &e.number) == 1;
+        } else if(strcmp(type, "end") != 0) {
+            valid = false;
+        }
+        if((e.type == input_event::INSERT_FLOPPY) || (e.type == input_event::EJECT_FLOPPY)) {
+            valid = valid && (e.number >= 0) && (e.number <= 1);
+        }
+        if(!valid || (!events.empty() && (clock < events.back().clock))) {
+            fprintf(stderr, "%s:%d: bad input \"%s\"\n", name, line_number, line);
+            fclose(fp);
+            return false;
+        }
+        events.push_back(e);
+    }
+    fclose(fp);
+    return true;
+}
+
+const char save_state_magic[8] = {'A', '2', 'E', 'S', 'T', 'A', 'T', 'E'};
+const uint32_t save_state_version = 5;
+
+// DOS 3.3's RWTS routines READ16 and RDADR16 as they are at $B8DC and
+// $B944 once DOS is loaded, for recognizing them before running them fast
+const uint8_t dos33_READ16_code[] = {
+    0xA0, 0x20, 0x88, 0xF0, 0x61, 0xBD, 0x8C, 0xC0, 0x10, 0xFB, 0x49, 0xD5, 0xD0, 0xF4, 0xEA, 0xBD,
+    0x8C, 0xC0, 0x10, 0xFB, 0xC9, 0xAA, 0xD0, 0xF2, 0xA0, 0x56, 0xBD, 0x8C, 0xC0, 0x10, 0xFB, 0xC9,
+    0xAD, 0xD0, 0xE7, 0xA9, 0x00, 0x88, 0x84, 0x26, 0xBC, 0x8C, 0xC0, 0x10, 0xFB, 0x59, 0x00, 0xBA,
+    0xA4, 0x26, 0x99, 0x00, 0xBC, 0xD0, 0xEE, 0x84, 0x26, 0xBC, 0x8C, 0xC0, 0x10, 0xFB, 0x59, 0x00,
+    0xBA, 0xA4, 0x26, 0x99, 0x00, 0xBB, 0xC8, 0xD0, 0xEE, 0xBC, 0x8C, 0xC0, 0x10, 0xFB, 0xD9, 0x00,
+    0xBA, 0xD0, 0x13, 0xBD, 0x8C, 0xC0, 0x10, 0xFB, 0xC9, 0xDE, 0xD0, 0x0A, 0xEA, 0xBD, 0x8C, 0xC0,
+    0x10, 0xFB, 0xC9, 0xAA, 0xF0, 0x5C, 0x38, 0x60,
+};
+
+const uint8_t dos33_RDADR16_code[] = {
+    0xA0, 0xFC, 0x84, 0x26, 0xC8, 0xD0, 0x04, 0xE6, 0x26, 0xF0, 0xF3, 0xBD, 0x8C, 0xC0, 0x10, 0xFB,
+    0xC9, 0xD5, 0xD0, 0xF0, 0xEA, 0xBD, 0x8C, 0xC0, 0x10, 0xFB, 0xC9, 0xAA, 0xD0, 0xF2, 0xA0, 0x03,
+    0xBD, 0x8C, 0xC0, 0x10, 0xFB, 0xC9, 0x96, 0xD0, 0xE7, 0xA9, 0x00, 0x85, 0x27, 0xBD, 0x8C, 0xC0,
+    0x10, 0xFB, 0x2A, 0x85, 0x26, 0xBD, 0x8C, 0xC0, 0x10, 0xFB, 0x25, 0x26, 0x99, 0x2C, 0x00, 0x45,
+    0x27, 0x88, 0x10, 0xE7, 0xA8, 0xD0, 0xB7, 0xBD, 0x8C, 0xC0, 0x10, 0xFB, 0xC9, 0xDE, 0xD0, 0xAE,
+    0xEA, 0xBD, 0x8C, 0xC0, 0x10, 0xFB, 0xC9, 0xAA, 0xD0, 0xA4, 0x18, 0x60,
+};
+
+// Waiting for the third byte of a 16-sector address prologue, as RWTS
+// and the Disk II drivers derived from it do, for telling a ProDOS block
+// driver for the Disk II from one for another card
+const uint8_t diskII_RDADR_96_code[] = {
+    0xBD, 0x8C, 0xC0, 0x10, 0xFB, 0xC9, 0x96, // LDA $C08C,X; BPL *-3; CMP #$96
+};
+
+// One whole machine - clock, motherboard, cards, and CPU.  Instances share
+// nothing that changes while running, so each can run on its own thread.
+struct apple2e_instance
+{
+    system_clock clk;
+    bus_frontend bus;
+    MAINboard *board;
+    DISKIIboard *diskII = nullptr;
+    Mockingboard *mockingboard = nullptr;
+    CPU6502JIT<system_clock, bus_frontend> cpu;
+
+    // Paddles are read through read_paddle() so they can be recorded
+    MAINboard::get_paddle_func paddle_source;
+
+    FILE *input_recording = nullptr;
+    bool paddle_recorded[4] = {false, false, false, false};
+    tuple<float, bool> recorded_paddles[4];
+
+    bool replaying = false;
+    deque<input_event> replay_queue; // everything but paddles
+    deque<input_event> replay_paddle_queue;
+    tuple<float, bool> replayed_paddles[4];
+
+    // Checkpoints for rewinding, each with the inputs that arrived after
+    // it so running forward from it to a later cycle repeats them
+    struct checkpoint
+    {
+        clk_t clock;
+        vector<uint8_t> state; // everything but memory
+        vector<paged_memory> memory;
+        DISKIIboard::floppy_contents floppies;
+        deque<input_event> inputs;
+    };
+    deque<checkpoint> checkpoints;
+    size_t max_checkpoints = 0; // 0 to not keep checkpoints
+    clk_t checkpoint_interval = 0;
+    clk_t next_checkpoint = 0;
+
+    bool fast_disk = false;
+
+    // Keyboard polling loops iterate without running up to this clock
+    clk_t idle_skip_limit = 0;
+
+    apple2e_instance(const uint8_t rom_image[32768], MAINboard::display_write_func display, MAINboard::audio_flush_func audio, MAINboard::get_paddle_func paddle) :
+        board(new MAINboard(clk, rom_image, display, audio, [this](int num){return read_paddle(num);})),
+        cpu(clk, bus),
+        paddle_source(paddle)
+    {
+        bus.board = board;
+        bus.reset();
+        cpu.trap = [this](decltype(cpu)&){ return (fast_disk && disk_trap()) || skip_idle_loop(); };
+    }
+
+    apple2e_instance(const apple2e_instance&) = delete;
+    apple2e_instance& operator=(const apple2e_instance&) = delete;
+
+    ~apple2e_instance()
+    {
+        stop_recording();
+        delete diskII;
+        delete mockingboard;
+        delete board;
+    }
+
+    void install_diskII(const uint8_t diskII_rom[256], const char *floppy0_name, const char *floppy1_name, DISKIIboard::floppy_activity_func activity)
+    {
+        diskII = new DISKIIboard(clk, diskII_rom, floppy0_name, floppy1_name, activity);
+        board->install_card(6, diskII);
+        mockingboard = new Mockingboard(clk, board->events, [this](){ board->irq_changed(); });
+        board->install_card(4, mockingboard);
+    }
+
+    // A new machine in the same state as this one, with no display or
+    // audio, sharing memory pages with this one until either writes to
+    // them.  This machine must not be running while it's forked.  The new
+    // machine starts with this one's floppies as they are in memory, and
+    // its floppy writes aren't written back to the images.
+    apple2e_instance *fork()
+    {
+        apple2e_instance *child = new apple2e_instance(nullptr,
+            [](uint16_t addr, bool aux, uint8_t data, clk_t when)->bool{return true;},
+            [](int16_t *buf, size_t sz){ },
+            paddle_source);
+        if(diskII) {
+            uint8_t diskII_rom[256];
+            diskII->rom_C600.memory.copy_out(diskII_rom);
+            child->install_diskII(diskII_rom, NULL, NULL, [](int num, bool activity){});
+            child->diskII->writeBack = false;
+            child->diskII->restore_floppies(diskII->save_floppies());
+        }
+        child->cpu.set_decode_cache(cpu.decode_cache_enabled);
+        child->cpu.set_jit(cpu.jit_enabled, cpu.jit_verify);
+        if(fast_disk) {
+            child->enable_fast_disk();
+        }
+
+        vector<uint8_t> state;
+        state_writer writer(&state);
+        transfer_state(writer);
+        state_reader reader(&state);
+        child->transfer_state(reader);
+        child->board->share_memory(*board);
+        if(fast_disk) {
+            child->find_prodos_driver();
+        }
+        return child;
     }
-};
 
-std::map<uint16_t, std::string> MAINboard::MMIO_named_locations =
-{
-    {0xC068, "STATEREG"},
-    {0xC05C, "CLRAN2"},
-    {0xC05E, "CLRAN3"},
-    {0xC05F, "SETAN3"},
-};
+    // Run until the CPU clock reaches end.  The CPU runs uninterrupted up
+    // to the earliest scheduled deadline, which an instruction can bring
+    // closer by scheduling an event, and the events due are run at the
+    // first instruction boundary at or after their deadlines, the same one
+    // with or without the JIT (see cycles_until_event()).
+    void run_until(clk_t end)
+    {
+        event_scheduler& events = board->events;
+        while(clk.clock_cpu < end) {
+            events.next_deadline();
+            while((clk.clock_cpu < end) && (clk.clock_cpu < events.earliest)) {
+                cpu.cycle();
+            }
+            run_due_events();
+        }
+    }
 
-struct bus_frontend
-{
-    MAINboard* board;
-    map<int, vector<uint8_t> > writes;
-    map<int, vector<uint8_t> > reads;
+    // Issue exactly one instruction, for callers that must look at every one
+    void step()
+    {
+        cpu.step();
+        run_due_events();
+    }
 
-    uint8_t read(uint16_t addr)
+    void run_due_events()
     {
-        uint8_t data = 0xaa;
-        if(board->read(addr & 0xFFFF, data)) {
-            if(debug & DEBUG_BUS)
-            {
-                printf("R %04X %02X\n", addr & 0xFFFF, data);
+        board->events.run_due(clk.clock_cpu);
+    }
+
+    // Every input from outside the machine but paddles comes through here,
+    // so it can be recorded
+    void apply_input(const input_event& e)
+    {
+        if(input_recording) {
+            write_input_event(input_recording, e);
+        }
+        if(!checkpoints.empty()) {
+            checkpoints.back().inputs.push_back(e);
+        }
+        switch(e.type) {
+            case input_event::KEY:
+                board->enqueue_key(e.number);
+                break;
+            case input_event::RESET:
+                bus.reset();
+                cpu.reset();
+                break;
+            case input_event::REBOOT:
+                bus.reset();
+                board->momentary_open_apple(machine_clock_rate / (5 * 14));
+                cpu.reset();
+                break;
+            case input_event::INSERT_FLOPPY:
+                if(diskII)
+                    diskII->set_floppy(e.number, e.name.c_str());
+                break;
+            case input_event::EJECT_FLOPPY:
+                if(diskII)
+                    diskII->set_floppy(e.number, NULL);
+                break;
+            case input_event::LOAD_STATE:
+                if(load_state(e.name.c_str()))
+                    printf("loaded state from %s\n", e.name.c_str());
+                break;
+            case input_event::PADDLE:
+            case input_event::END:
+                break;
+        }
+    }
+
+    tuple<float, bool> read_paddle(int num)
+    {
+        if(replaying) {
+            while(!replay_paddle_queue.empty() && (replay_paddle_queue.front().clock <= clk.clock_cpu)) {
+                const input_event& e = replay_paddle_queue.front();
+                replayed_paddles[e.number] = make_tuple(e.value, e.button);
+                replay_paddle_queue.pop_front();
             }
-            // reads[addr & 0xFFFF].push_back(data);
-            return data;
+            return replayed_paddles[num];
         }
-        if(debug & DEBUG_ERROR) {
-            fprintf(stderr, "no ownership of read at %04X\n", addr & 0xFFFF);
+        tuple<float, bool> paddle = paddle_source(num);
+        if(input_recording && (!paddle_recorded[num] || (paddle != recorded_paddles[num]))) {
+            input_event e(clk.clock_cpu, input_event::PADDLE, num);
+            tie(e.value, e.button) = paddle;
+            write_input_event(input_recording, e);
+            paddle_recorded[num] = true;
+            recorded_paddles[num] = paddle;
         }
-        return 0xAA;
+        return paddle;
     }
-    void write(uint16_t addr, uint8_t data)
+
+    bool start_recording(const char *name)
     {
-        if(board->write(addr & 0xFFFF, data)) {
-            if(debug & DEBUG_BUS)
-            {
-                printf("W %04X %02X\n", addr & 0xFFFF, data);
+        input_recording = fopen(name, "w");
+        if(input_recording == NULL) {
+            fprintf(stderr, "failed to open %s for writing\n", name);
+            return false;
+        }
+        return true;
+    }
+
+    // Queue floppy writes not yet written back, for exits that skip the
+    // destructor
+    void flush_floppies()
+    {
+        if(diskII) {
+            diskII->flushFloppies();
+        }
+    }
+
+    void stop_recording()
+    {
+        if(input_recording) {
+            write_input_event(input_recording, input_event(clk.clock_cpu, input_event::END));
+            fclose(input_recording);
+            input_recording = nullptr;
+        }
+    }
+
+    // Replayed inputs take the place of paddles and are applied by
+    // replay_inputs(), which must be called at every clock an input might
+    // be due
+    bool start_replay(const char *name)
+    {
+        deque<input_event> events;
+        if(!read_input_events(name, events)) {
+            return false;
+        }
+        for(auto& e : events) {
+            if(e.type == input_event::PADDLE) {
+                replay_paddle_queue.push_back(e);
+            } else {
+                replay_queue.push_back(e);
             }
-            // writes[addr & 0xFFFF].push_back(data);
+        }
+        for(int i = 0; i < 4; i++) {
+            replayed_paddles[i] = make_tuple(0.0f, false);
+        }
+        replaying = true;
+        return true;
+    }
+
+    void replay_inputs()
+    {
+        while(!replay_queue.empty() && (replay_queue.front().clock <= clk.clock_cpu)) {
+            apply_input(replay_queue.front());
+            replay_queue.pop_front();
+        }
+    }
+
+    // The clock of the next replayed input, or the largest clock if none
+    clk_t next_replay_clock() const
+    {
+        return replay_queue.empty() ? std::numeric_limits<clk_t>::max() : replay_queue.front().clock;
+    }
+
+    bool replay_finished() const
+    {
+        return replaying && replay_queue.empty();
+    }
+
+    // Keep up to count checkpoints, one every interval CPU cycles
+    void enable_rewind(clk_t interval, size_t count)
+    {
+        checkpoint_interval = interval;
+        max_checkpoints = count;
+        if(diskII) {
+            diskII->holdWrites = (count > 0);
+        }
+        next_checkpoint = clk.clock_cpu;
+    }
+
+    void take_checkpoint()
+    {
+        checkpoints.emplace_back();
+        checkpoint& c = checkpoints.back();
+        c.clock = clk.clock_cpu;
+        state_writer writer(&c.state);
+        transfer_state(writer);
+        board->checkpoint_memory(c.memory);
+        if(diskII) {
+            c.floppies = diskII->save_floppies();
+        }
+        if(checkpoints.size() > max_checkpoints) {
+            checkpoints.pop_front();
+        }
+        next_checkpoint = clk.clock_cpu + checkpoint_interval;
+    }
+
+    // Must be called between instructions
+    void checkpoint_if_due()
+    {
+        if(max_checkpoints && (clk.clock_cpu >= next_checkpoint)) {
+            take_checkpoint();
+        }
+    }
+
+    // Return to the latest checkpoint at or before the target cycle and
+    // run forward to the first instruction boundary at or past it,
+    // applying the inputs that arrived in between again.  Paddles read
+    // as they are now.  Checkpoints after the target are dropped.  The
+    // floppies go back to what they held at the checkpoint, but a floppy
+    // ejected since then was written back to its image at the time.
+    bool rewind_to(clk_t target)
+    {
+        if(input_recording) {
+            fprintf(stderr, "can't rewind while recording inputs\n");
+            return false;
+        }
+        if(target >= clk.clock_cpu) {
+            fprintf(stderr, "cycle %llu isn't in the past\n", (unsigned long long)target);
+            return false;
+        }
+        auto it = checkpoints.end();
+        while((it != checkpoints.begin()) && (prev(it)->clock > target)) {
+            it--;
+        }
+        if(it == checkpoints.begin()) {
+            fprintf(stderr, "no checkpoint at or before cycle %llu\n", (unsigned long long)target);
+            return false;
+        }
+        it--;
+
+        deque<input_event> inputs;
+        for(auto later = it; later != checkpoints.end(); later++) {
+            inputs.insert(inputs.end(), later->inputs.begin(), later->inputs.end());
+        }
+        checkpoints.erase(next(it), checkpoints.end());
+        it->inputs.clear();
+
+        board->restore_memory(it->memory);
+        if(diskII) {
+            if(diskII->lastWriteBack > it->clock) {
+                fprintf(stderr, "warning: floppy images were written at cycle %llu, after the checkpoint at cycle %llu, and keep those writes\n",
+                    (unsigned long long)diskII->lastWriteBack, (unsigned long long)it->clock);
+            }
+            diskII->restore_floppies(it->floppies);
+        }
+        state_reader reader(&it->state);
+        transfer_state(reader);
+
+        clk_t skip_limit = idle_skip_limit;
+        idle_skip_limit = 0;
+        while(clk.clock_cpu < target) {
+            while(!inputs.empty() && (inputs.front().clock <= clk.clock_cpu)) {
+                apply_input(inputs.front());
+                inputs.pop_front();
+            }
+            step();
+        }
+        idle_skip_limit = skip_limit;
+        next_checkpoint = it->clock + checkpoint_interval;
+        return true;
+    }
+
+    // With fast_disk, calls to DOS 3.3's RWTS routines that read an
+    // address field (RDADR16) and a sector's data field (READ16) are done
+    // here straight from the track instead of by polling the Disk II a
+    // nybble at a time.  Only code matching DOS 3.3's byte for byte is
+    // trapped, and only fields that read cleanly; anything else, and any
+    // WOZ image, runs as usual.  A trapped read takes no time on the
+    // machine's clock beyond its memory writes and the return.
+    //
+    // ProDOS's Disk II driver moves with the version, so it's found
+    // instead: each call to the MLI at $BF00 looks up slot 6's entry in
+    // the global page's device table and traps it if the code there
+    // waits for an address prologue the way RWTS does.  READ_BLOCK
+    // requests to that driver are answered from the track.
+    static constexpr uint16_t dos33_READ16 = 0xB8DC;
+    static constexpr uint16_t dos33_RDADR16 = 0xB944;
+    static constexpr uint8_t diskII_slot_x = 0x60; // slot 6 * 16, as RWTS indexes $C08C
+    static constexpr uint16_t prodos_MLI = 0xBF00;
+    static constexpr uint16_t prodos_DEVADR = 0xBF10; // drivers by unit number / 16: slot, then slot + 8 for drive 2
+    static constexpr uint16_t prodos_driver_size = 0x800; // how far past a driver's entry to look for its code
+
+    void enable_fast_disk()
+    {
+        fast_disk = true;
+        cpu.set_trap(dos33_READ16);
+        cpu.set_trap(dos33_RDADR16);
+        cpu.set_trap(prodos_MLI);
+    }
+
+    bool code_matches(uint16_t address, const uint8_t *code, size_t size)
+    {
+        for(size_t i = 0; i < size; i++) {
+            if(bus.read(address + i) != code[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool disk_trap()
+    {
+        if(!diskII) {
+            return false;
+        }
+        if(cpu.pc == prodos_MLI) {
+            find_prodos_driver();
+            return false;
+        }
+        if((cpu.pc != dos33_RDADR16) && (cpu.pc != dos33_READ16)) {
+            return fast_read_block();
+        }
+        const uint8_t *track;
+        uint32_t index;
+        if((cpu.x != diskII_slot_x) || !diskII->nextTrackBytes(track, index)) {
+            return false;
+        }
+        if(cpu.pc == dos33_RDADR16) {
+            return code_matches(dos33_RDADR16, dos33_RDADR16_code, sizeof(dos33_RDADR16_code)) &&
+                fast_read_address(track, index);
+        } else if(cpu.pc == dos33_READ16) {
+            return code_matches(dos33_READ16, dos33_READ16_code, sizeof(dos33_READ16_code)) &&
+                fast_read_data(track, index);
+        }
+        return false;
+    }
+
+    uint16_t prodos_driver_address(uint8_t unit)
+    {
+        uint16_t entry = prodos_DEVADR + (unit >> 4) * 2;
+        return board->peek(entry) + board->peek((entry + 1) % 65536) * 256;
+    }
+
+    // A Disk II driver is one whose code soon after its entry polls Q6L
+    // for the third byte of an address prologue.  Peeked, so looking
+    // doesn't touch the softswitches.
+    bool is_diskII_driver(uint16_t address)
+    {
+        for(int offset = 0; offset < prodos_driver_size; offset++) {
+            size_t i = 0;
+            while((i < sizeof(diskII_RDADR_96_code)) &&
+                (board->peek((address + offset + i) % 65536) == diskII_RDADR_96_code[i])) {
+                i++;
+            }
+            if(i == sizeof(diskII_RDADR_96_code)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // If ProDOS is running, trap the drivers of slot 6's drives.  Done at
+    // MLI calls and after loading state, so a loaded machine traps what
+    // the one it was saved from does.
+    void find_prodos_driver()
+    {
+        if(board->peek(prodos_MLI) != 0x4C) { // JMP
             return;
         }
-        if(debug & DEBUG_ERROR) {
-            fprintf(stderr, "no ownership of write %02X at %04X\n", data, addr & 0xFFFF);
+        for(int unit : {0x60, 0xE0}) {
+            uint16_t driver = prodos_driver_address(unit);
+            if(is_diskII_driver(driver)) {
+                cpu.set_trap(driver);
+            }
+        }
+    }
+
+    // ProDOS block device call at a trapped driver entry: command in $42,
+    // unit number (drive 2 in bit 7, slot in bits 6-4) in $43, buffer at
+    // ($44), block number in $46 and $47.  A READ_BLOCK of slot 6 whose
+    // sectors decode cleanly is copied to the buffer and returns as the
+    // driver does without error, A = 0 and carry clear; the head and the
+    // driver's variables are left as they were.
+    bool fast_read_block()
+    {
+        uint8_t command = board->peek(0x42);
+        uint8_t unit = board->peek(0x43);
+        if((command != 1) || ((unit & 0x70) != diskII_slot_x) ||
+            (prodos_driver_address(unit) != cpu.pc) || !is_diskII_driver(cpu.pc)) {
+            return false;
+        }
+        uint16_t buffer = board->peek(0x44) + board->peek(0x45) * 256;
+        int block = board->peek(0x46) + board->peek(0x47) * 256;
+        uint8_t data[2 * DiskII::sectorSize];
+        if(!diskII->readBlock(unit >> 7, block, data)) {
+            return false;
+        }
+        for(int i = 0; i < 2 * DiskII::sectorSize; i++) {
+            cpu.write(buffer + i, data[i]);
+        }
+        cpu.a = 0;
+        return_with_clc();
+        return true;
+    }
+
+    // Leave the registers, flags, and stack as RDADR16 and READ16 do
+    // when they succeed: A holds the $AA ending the epilogue and the
+    // routine returns with CLC; RTS
+    void fast_read_return(uint8_t y)
+    {
+        cpu.a = 0xAA;
+        cpu.y = y;
+        return_with_clc();
+    }
+
+    void return_with_clc()
+    {
+        cpu.p = (cpu.p & ~(cpu.N | cpu.Z | cpu.C)) | cpu.Z;
+        clk.add_cpu_cycles(2);
+        uint8_t pcl = cpu.stack_pull();
+        uint8_t pch = cpu.stack_pull();
+        clk.add_cpu_cycles(1);
+        cpu.pc = pcl + pch * 256 + 1;
+    }
+
+    // RDADR16: volume, track, sector, and checksum of the next address
+    // field go to $2F down to $2C.  Gives up where RDADR16 would stop
+    // looking for the prologue.
+    bool fast_read_address(const uint8_t *track, uint32_t index)
+    {
+        auto at = [&](uint32_t i) { return track[(index + i) % DiskII::nybblizedTrackSize]; };
+        uint32_t start = 0;
+        while((at(start) != 0xD5) || (at(start + 1) != 0xAA) || (at(start + 2) != 0x96)) {
+            if(++start > 768) {
+                return false;
+            }
+        }
+        uint8_t fields[4];
+        for(int i = 0; i < 4; i++) {
+            fields[i] = ((at(start + 3 + i * 2) << 1) | 1) & at(start + 4 + i * 2);
+        }
+        if(((fields[0] ^ fields[1] ^ fields[2] ^ fields[3]) != 0) ||
+            (at(start + 11) != 0xDE) || (at(start + 12) != 0xAA)) {
+            return false;
+        }
+        uint8_t sum = 0;
+        for(int i = 0; i < 4; i++) {
+            cpu.write(0x27, sum);
+            cpu.write(0x26, (at(start + 3 + i * 2) << 1) | 1);
+            cpu.write(0x2F - i, fields[i]);
+            sum ^= fields[i];
+        }
+        diskII->skipTrackBytes(start + 13);
+        fast_read_return(0);
+        return true;
+    }
+
+    // READ16: the 342 six-bit values of the next data field go to NBUF2
+    // ($BC55 down to $BC00) and NBUF1 ($BB00 up to $BBFF) for POSTNB16
+    bool fast_read_data(const uint8_t *track, uint32_t index)
+    {
+        auto at = [&](uint32_t i) { return track[(index + i) % DiskII::nybblizedTrackSize]; };
+        uint32_t start = 0;
+        while((at(start) != 0xD5) || (at(start + 1) != 0xAA) || (at(start + 2) != 0xAD)) {
+            if(++start > 28) {
+                return false;
+            }
+        }
+        uint8_t values[343];
+        int sum = 0;
+        for(int i = 0; i < 343; i++) {
+            int sixBits = DiskII::BytesToSixBits[at(start + 3 + i)];
+            if(sixBits < 0) {
+                return false;
+            }
+            sum ^= sixBits;
+            values[i] = sum;
+        }
+        if((sum != 0) || (at(start + 346) != 0xDE) || (at(start + 347) != 0xAA)) {
+            return false;
+        }
+        for(int i = 0; i < 0x56; i++) {
+            cpu.write(0xBC55 - i, values[i]);
+        }
+        for(int i = 0; i < 0x100; i++) {
+            cpu.write(0xBB00 + i, values[0x56 + i]);
+        }
+        cpu.write(0x26, 0xFF);
+        diskII->skipTrackBytes(start + 348);
+        fast_read_return(at(start + 345));
+        return true;
+    }
+
+    // A loop polling the keyboard that changes nothing else from one
+    // iteration to the next while no key is waiting, or only counts in a
+    // zero page byte while the count doesn't carry:
+    //
+    //     head: [INC counter; BNE poll; ...]
+    //     poll: LDA or BIT $C000; BPL head
+    //
+    // Both the monitor's KEYIN and the //e's 80-column firmware wait like
+    // this.  Once one is found running at the end of a slice, its head
+    // gets a trap that does as many iterations as fit before
+    // idle_skip_limit at once, leaving registers, flags, the counter, and
+    // the clock as running them would.
+    struct idle_loop
+    {
+        int counter; // zero page address, or -1
+        uint16_t poll;
+        clk_t cycles; // per iteration
+    };
+
+    static clk_t taken_branch_cycles(uint16_t address, uint8_t offset)
+    {
+        uint16_t next = address + 2;
+        uint16_t target = next + (int8_t)offset;
+        return ((target / 256) != (next / 256)) ? 4 : 3;
+    }
+
+    // The address a "LDA/BIT $C000; BPL" at poll branches back to, or -1
+    int poll_loop_head(uint16_t poll)
+    {
+        uint8_t op = board->peek(poll);
+        if(((op != 0xAD) && (op != 0x2C)) || (board->peek(poll + 1) != 0x00) ||
+            (board->peek(poll + 2) != 0xC0) || (board->peek(poll + 3) != 0x10)) {
+            return -1;
+        }
+        return (uint16_t)(poll + 5 + (int8_t)board->peek(poll + 4));
+    }
+
+    bool match_idle_loop(uint16_t head, idle_loop& loop)
+    {
+        if(poll_loop_head(head) == head) {
+            loop.counter = -1;
+            loop.poll = head;
+            loop.cycles = 4 + taken_branch_cycles(head + 3, board->peek(head + 4));
+            return true;
+        }
+        if((board->peek(head) == 0xE6) && (board->peek(head + 2) == 0xD0)) {
+            uint16_t poll = head + 4 + (int8_t)board->peek(head + 3);
+            if(poll_loop_head(poll) == head) {
+                loop.counter = board->peek(head + 1);
+                loop.poll = poll;
+                loop.cycles = 5 + taken_branch_cycles(head + 2, board->peek(head + 3)) +
+                    4 + taken_branch_cycles(poll + 3, board->peek(poll + 4));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Between slices: put a trap on the polling loop pc is in, if any
+    void watch_for_idle_loop()
+    {
+        idle_loop loop;
+        int heads[] = {cpu.pc, cpu.pc - 2, poll_loop_head(cpu.pc), poll_loop_head(cpu.pc - 3)};
+        for(int head : heads) {
+            if((head >= 0) && match_idle_loop(head, loop)) {
+                cpu.set_trap(head);
+                return;
+            }
+        }
+    }
+
+    bool skip_idle_loop()
+    {
+        idle_loop loop;
+        if((clk.clock_cpu >= idle_skip_limit) || !match_idle_loop(cpu.pc, loop)) {
+            return false;
+        }
+        uint8_t key = bus.read(0xC000);
+        if(key & 0x80) {
+            return false;
+        }
+        clk_t until = std::min(idle_skip_limit, std::max(board->events.next_deadline(), clk.clock_cpu)); // devices may change something
+        clk_t iterations = (until - clk.clock_cpu) / loop.cycles;
+        if(loop.counter >= 0) {
+            iterations = std::min(iterations, (clk_t)(0xFF - board->peek(loop.counter)));
+        }
+        if(iterations == 0) {
+            return false;
+        }
+        if(loop.counter >= 0) {
+            cpu.invalidate_decoded_page(loop.counter);
+            bus.write(loop.counter, board->peek(loop.counter) + iterations);
+        }
+        clk.add_cpu_cycles(iterations * loop.cycles);
+        if(board->peek(loop.poll) == 0xAD) { // LDA
+            cpu.a = key;
+            cpu.p = (cpu.p & ~(cpu.N | cpu.Z)) | ((key == 0) ? cpu.Z : 0);
+        } else { // BIT
+            cpu.p = (cpu.p & ~(cpu.N | cpu.V | cpu.Z)) | (key & cpu.V) | (((cpu.a & key) == 0) ? cpu.Z : 0);
+        }
+        return true;
+    }
+
+    template <class S>
+    void transfer_state(S& s)
+    {
+        s.value(clk.clock_cpu);
+        s.value(clk.clock_14mhz);
+        s.value(clk.phase_hpe);
+        s.value(cpu.a);
+        s.value(cpu.x);
+        s.value(cpu.y);
+        s.value(cpu.s);
+        s.value(cpu.p);
+        s.value(cpu.pc);
+        s.value(cpu.exception);
+        board->transfer_state(s);
+        if(diskII) {
+            diskII->transfer_state(s);
+            mockingboard->transfer_state(s);
+        }
+        if(S::loading) {
+            cpu.invalidate_decode_cache();
+            if(fast_disk && diskII) {
+                find_prodos_driver();
+            }
+        }
+    }
+
+    // A state file starts with a magic number, a version, and whether a
+    // Disk II was installed, then holds what transfer_state() transfers
+    bool save_state(const char *name)
+    {
+        FILE *fp = fopen(name, "wb");
+        if(fp == NULL) {
+            fprintf(stderr, "failed to open %s for writing\n", name);
+            return false;
+        }
+        state_writer s(fp);
+        char magic[8];
+        memcpy(magic, save_state_magic, sizeof(magic));
+        uint32_t version = save_state_version;
+        uint8_t has_diskII = (diskII != nullptr);
+        s.bytes(magic, sizeof(magic));
+        s.value(version);
+        s.value(has_diskII);
+        transfer_state(s);
+        if(fclose(fp) != 0) {
+            s.ok = false;
+        }
+        if(!s.ok) {
+            fprintf(stderr, "failed to write state to %s\n", name);
+        }
+        return s.ok;
+    }
+
+    bool load_state(const char *name)
+    {
+        FILE *fp = fopen(name, "rb");
+        if(fp == NULL) {
+            fprintf(stderr, "failed to open %s for reading\n", name);
+            return false;
+        }
+        state_reader s(fp);
+        char magic[8];
+        uint32_t version = 0;
+        uint8_t has_diskII = 0;
+        s.bytes(magic, sizeof(magic));
+        s.value(version);
+        s.value(has_diskII);
+        if(!s.ok || (memcmp(magic, save_state_magic, sizeof(magic)) != 0) || (version != save_state_version)) {
+            fprintf(stderr, "%s isn't a save state from this version of the emulator\n", name);
+            fclose(fp);
+            return false;
+        }
+        if((has_diskII != 0) != (diskII != nullptr)) {
+            fprintf(stderr, "%s was saved %s a Disk II controller\n", name, has_diskII ? "with" : "without");
+            fclose(fp);
+            return false;
         }
-    }
-
-    void reset()
-    {
-        board->reset();
+        transfer_state(s);
+        fclose(fp);
+        if(!s.ok) {
+            fprintf(stderr, "failed to read state from %s, machine state may be inconsistent\n", name);
+        }
+        return s.ok;
     }
 };
 
-bus_frontend bus;
-
 #ifdef SUPPORT_FAKE_6502
 
+// fake6502 has no context argument, so it always runs the interactive machine
+bus_frontend *fake6502_bus;
+
 extern "C" {
 
 uint8_t read6502(uint16_t address) 
 {
-    return bus.read(address);
+    return fake6502_bus->read(address);
 }
 
 void write6502(uint16_t address, uint8_t value)
 {
-    bus.write(address, value);
+    fake6502_bus->write(address, value);
 }
 
 };
@@ -2005,10 +4823,29 @@ void usage(const char *progname)
     printf("    -debugger               start in the debugger\n");
     printf("    -d MASK                 enable various debug states\n");
     printf("    -fast                   run full speed (not real time)\n");
+    printf("    -warp-disk              run full speed while a floppy drive motor is on\n");
+    printf("    -decode-cache           replay decoded instructions instead of refetching\n");
+    printf("    -jit                    translate hot 6502 code to native code (x86-64 Linux)\n");
+    printf("    -jit-verify             -jit, checking every translated block against the interpreter\n");
+    printf("    -fast-disk              read DOS 3.3 sectors and ProDOS blocks straight from the track\n");
     printf("    -diskII ROM.bin floppy1 floppy2\n");
     printf("                            insert two floppies (or \"-\" for none)\n");
     printf("    -map ld65.map           specify ld65 map file for debug output\n");
     printf("    -backspace-is-delete    map delete key to backspace instead of left arrow\n");
+    printf("    -headless               no window or audio, run flat out until a stop condition\n");
+    printf("    -cycles N               (headless) stop after N CPU cycles\n");
+    printf("    -until-pc ADDR          (headless) stop when the PC reaches ADDR\n");
+    printf("    -until-mem ADDR VALUE   (headless) stop when memory at ADDR holds VALUE\n");
+    printf("    -keys script.txt        (headless) type the script as the machine reads keys\n");
+    printf("    -dump PREFIX            (headless) write PREFIX.txt, .hgr, .mem, and .ppm at exit\n");
+    printf("    -save-state FILE        (headless) save the machine's state to FILE at exit\n");
+    printf("    -load-state FILE        start from the machine state saved in FILE\n");
+    printf("    -rewind MILLIS COUNT    keep COUNT checkpoints MILLIS of emulated time apart to rewind to\n");
+    printf("    -record FILE            log every key, paddle, reset, and floppy change to FILE\n");
+    printf("    -video FORMAT           record the screen from startup as gif, y4m, or ppm\n");
+    printf("    -replay FILE            (headless) feed the inputs logged in FILE at their exact cycles\n");
+    printf("    -jobs jobs.txt          run one headless machine per line of jobs.txt in parallel\n");
+    printf("    -threads N              (jobs) run at most N machines at once (default: one per core)\n");
     printf("\n");
     printf("\n");
 }
@@ -2100,28 +4937,30 @@ map<int, key_to_ascii> interface_key_to_apple2e =
     {' ', {' ', ' ', 0, 0}},
 };
 
-DISKIIboard *diskIIboard;
-Mockingboard *mockingboard;
-
-enum APPLE2Einterface::EventType process_events(MAINboard *board, bus_frontend& bus, CPU6502<system_clock, bus_frontend>& cpu)
+enum APPLE2Einterface::EventType process_events(apple2e_instance& machine)
 {
     static bool shift_down = false;
     static bool control_down = false;
     static bool caps_down = false;
 
+    // Inputs go through apply_input() so they can be recorded
+    auto type_key = [&](uint8_t k) {
+        machine.apply_input(input_event(machine.clk.clock_cpu, input_event::KEY, k));
+    };
+
     while(APPLE2Einterface::event_waiting()) {
         APPLE2Einterface::event e = APPLE2Einterface::dequeue_event();
         if(e.type == APPLE2Einterface::EJECT_FLOPPY) {
-            diskIIboard->set_floppy(e.value, NULL);
+            machine.apply_input(input_event(machine.clk.clock_cpu, input_event::EJECT_FLOPPY, e.value));
         } else if(e.type == APPLE2Einterface::INSERT_FLOPPY) {
-            diskIIboard->set_floppy(e.value, e.str);
+            machine.apply_input(input_event(machine.clk.clock_cpu, input_event::INSERT_FLOPPY, e.value, e.str));
             free(e.str);
         } else if(e.type == APPLE2Einterface::PASTE) {
             for(uint32_t i = 0; i < strlen(e.str); i++)
                 if(e.str[i] == '\n')
-                    board->enqueue_key('\r');
+                    type_key('\r');
                 else
-                    board->enqueue_key(e.str[i]);
+                    type_key(e.str[i]);
             free(e.str);
         } else if(e.type == APPLE2Einterface::KEYDOWN) {
             if((e.value == APPLE2Einterface::LEFT_SHIFT) || (e.value == APPLE2Einterface::RIGHT_SHIFT))
@@ -2131,25 +4970,25 @@ enum APPLE2Einterface::EventType process_events(MAINboard *board, bus_frontend&
             else if(e.value == APPLE2Einterface::CAPS_LOCK) {
                 caps_down = true;
             } else if(e.value == APPLE2Einterface::ENTER) {
-                board->enqueue_key(141 - 128);
+                type_key(141 - 128);
             } else if(e.value == APPLE2Einterface::TAB) {
-                board->enqueue_key('	');
+                type_key('	');
             } else if(e.value == APPLE2Einterface::ESCAPE) {
-                board->enqueue_key('');
+                type_key('');
             } else if(e.value == APPLE2Einterface::BACKSPACE) {
                 if(delete_is_left_arrow) {
-                    board->enqueue_key(136 - 128);
+                    type_key(136 - 128);
                 } else {
-                    board->enqueue_key(255 - 128);
+                    type_key(255 - 128);
                 }
             } else if(e.value == APPLE2Einterface::RIGHT) {
-                board->enqueue_key(149 - 128);
+                type_key(149 - 128);
             } else if(e.value == APPLE2Einterface::LEFT) {
-                board->enqueue_key(136 - 128);
+                type_key(136 - 128);
             } else if(e.value == APPLE2Einterface::DOWN) {
-                board->enqueue_key(138 - 128);
+                type_key(138 - 128);
             } else if(e.value == APPLE2Einterface::UP) {
-                board->enqueue_key(139 - 128);
+                type_key(139 - 128);
             } else {
                 auto it = interface_key_to_apple2e.find(e.value);
                 if(it != interface_key_to_apple2e.end()) {
@@ -2157,16 +4996,16 @@ enum APPLE2Einterface::EventType process_events(MAINboard *board, bus_frontend&
                     if(!shift_down) {
                         if(!control_down) {
                             if(caps_down && (e.value >= 'A') && (e.value <= 'Z'))
-                                board->enqueue_key(k.yes_shift_no_control);
+                                type_key(k.yes_shift_no_control);
                             else
-                                board->enqueue_key(k.no_shift_no_control);
+                                type_key(k.no_shift_no_control);
                         } else  
-                            board->enqueue_key(k.no_shift_yes_control);
+                            type_key(k.no_shift_yes_control);
                     } else {
                         if(!control_down)
-                            board->enqueue_key(k.yes_shift_no_control);
+                            type_key(k.yes_shift_no_control);
                         else
-                            board->enqueue_key(k.yes_shift_yes_control);
+                            type_key(k.yes_shift_yes_control);
                     }
                 }
             }
@@ -2179,22 +5018,36 @@ enum APPLE2Einterface::EventType process_events(MAINboard *board, bus_frontend&
                 caps_down = false;
             }
         } if(e.type == APPLE2Einterface::RESET) {
-            bus.reset();
 #ifdef SUPPORT_FAKE_6502
-            if(use_fake6502)
+            if(use_fake6502) {
+                machine.bus.reset();
                 reset6502();
-            else
+            } else
 #endif
-                cpu.reset();
+                machine.apply_input(input_event(machine.clk.clock_cpu, input_event::RESET));
         } else if(e.type == APPLE2Einterface::REBOOT) {
-            bus.reset();
-            board->momentary_open_apple(machine_clock_rate / (5 * 14));
 #ifdef SUPPORT_FAKE_6502
-            if(use_fake6502)
+            if(use_fake6502) {
+                machine.bus.reset();
+                machine.board->momentary_open_apple(machine_clock_rate / (5 * 14));
                 reset6502();
-            else
+            } else
 #endif
-                cpu.reset();
+                machine.apply_input(input_event(machine.clk.clock_cpu, input_event::REBOOT));
+        } else if(e.type == APPLE2Einterface::SAVE_STATE) {
+            if(machine.save_state(e.str))
+                printf("saved state to %s\n", e.str);
+            free(e.str);
+        } else if(e.type == APPLE2Einterface::LOAD_STATE) {
+            machine.apply_input(input_event(machine.clk.clock_cpu, input_event::LOAD_STATE, 0, e.str));
+            free(e.str);
+        } else if(e.type == APPLE2Einterface::REWIND) {
+            clk_t back = (clk_t)e.value * machine_clock_rate / 14 / 1000;
+            clk_t target = (machine.clk.clock_cpu > back) ? (machine.clk.clock_cpu - back) : 0;
+            if(!machine.checkpoints.empty()) {
+                target = max(target, machine.checkpoints.front().clock);
+            }
+            machine.rewind_to(target);
         } else if(e.type == APPLE2Einterface::PAUSE) {
             pause_cpu = e.value;
         } else if(e.type == APPLE2Einterface::SPEED) {
@@ -2273,6 +5126,457 @@ struct averaged_sequence
     }
 };
 
+struct headless_options
+{
+    clk_t cycles = 0; // 0 for no limit
+    int until_pc = -1;
+    int until_mem_address = -1;
+    uint8_t until_mem_value = 0;
+    const char *keys_name = nullptr;
+    const char *replay_name = nullptr;
+    const char *dump_prefix = nullptr;
+    const char *save_state_name = nullptr;
+
+    // Without one a headless run would never finish
+    bool has_stop_condition() const
+    {
+        return (cycles > 0) || (until_pc >= 0) || (until_mem_address >= 0) || (replay_name != nullptr);
+    }
+};
+
+struct scripted_key
+{
+    bool wait; // pause typing instead of typing a key
+    clk_t cycles;
+    uint8_t key;
+};
+
+// Keys are typed as written, with newlines typed as RETURN.  A line
+// "@wait CYCLES" pauses typing for that many CPU cycles instead.
+bool read_key_script(const char *name, deque<scripted_key>& script)
+{
+    FILE *fp = fopen(name, "r");
+    if(fp == NULL) {
+        fprintf(stderr, "failed to open %s for reading\n", name);
+        return false;
+    }
+    char line[512];
+    while(fgets(line, sizeof(line), fp) != NULL) {
+        unsigned long long cycles;
+        if(sscanf(line, "@wait %llu", &cycles) == 1) {
+            script.push_back({true, cycles, 0});
+            continue;
+        }
+        for(char *c = line; *c; c++) {
+            script.push_back({false, 0, (uint8_t)((*c == '\n') ? '\r' : *c)});
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+char text_to_ascii(uint8_t c)
+{
+    c = (c < 0x80) ? (c & 0x3F) : (c & 0x7F);
+    return (c < 0x20) ? (c + 0x40) : c;
+}
+
+void dump_text_page(MAINboard *board, FILE *fp)
+{
+    for(int row = 0; row < 24; row++) {
+        int offset = (row % 8) * 0x80 + (row / 8) * 0x28;
+        for(int col = 0; col < 40; col++) {
+            if(board->VID80) {
+                fputc(text_to_ascii(board->text_page1x.memory[offset + col]), fp);
+            }
+            fputc(text_to_ascii(board->text_page1.memory[offset + col]), fp);
+        }
+        fputc('\n', fp);
+    }
+}
+
+// Draw the display as it is now on the CPU, in the current video mode
+void render_screen(MAINboard *board, bool color, uint8_t *pixels)
+{
+    vector<uint8_t> text(0x400 * 4);
+    vector<uint8_t> hires(0x2000 * 4);
+    board->text_page1.memory.copy_out(&text[0x000]);
+    board->text_page2.memory.copy_out(&text[0x400]);
+    board->text_page1x.memory.copy_out(&text[0x800]);
+    board->text_page2x.memory.copy_out(&text[0xC00]);
+    board->hires_page1.memory.copy_out(&hires[0x0000]);
+    board->hires_page2.memory.copy_out(&hires[0x2000]);
+    board->hires_page1x.memory.copy_out(&hires[0x4000]);
+    board->hires_page2x.memory.copy_out(&hires[0x6000]);
+    APPLE2Einterface::video_memory memory;
+    for(int aux = 0; aux < 2; aux++) {
+        for(int page = 0; page < 2; page++) {
+            memory.text[aux][page] = &text[(aux * 2 + page) * 0x400];
+            memory.hires[aux][page] = &hires[(aux * 2 + page) * 0x2000];
+        }
+    }
+    APPLE2Einterface::ModeSettings line_modes[APPLE2Einterface::video_frame_height];
+    std::fill(line_modes, line_modes + APPLE2Einterface::video_frame_height, board->convert_switches_to_mode_settings());
+    APPLE2Einterface::render_video(memory, line_modes, color, false, pixels);
+}
+
+bool dump_to_file(const char *prefix, const char *suffix, const uint8_t *data, size_t size)
+{
+    string name = string(prefix) + suffix;
+    FILE *fp = fopen(name.c_str(), "wb");
+    if(fp == NULL) {
+        fprintf(stderr, "failed to open %s for writing\n", name.c_str());
+        return false;
+    }
+    size_t length = fwrite(data, 1, size, fp);
+    fclose(fp);
+    if(length < size) {
+        fprintf(stderr, "failed to write %s\n", name.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Run as fast as possible with no display, audio, or event polling until
+// a stop condition is met, so options must have one.  Returns why it
+// stopped, or nullptr if the key script or replay log couldn't be read.
+const char *run_headless(apple2e_instance& machine, const headless_options& options)
+{
+    MAINboard *board = machine.board;
+    system_clock& clk = machine.clk;
+    auto& cpu = machine.cpu;
+
+    deque<scripted_key> script;
+    if(options.keys_name && !read_key_script(options.keys_name, script)) {
+        return nullptr;
+    }
+    if(options.replay_name && !machine.start_replay(options.replay_name)) {
+        return nullptr;
+    }
+
+    const clk_t cycles_per_sync = machine_clock_rate / 14 / 60;
+    scheduled_event sync_event;
+    sync_event.action = [&](){
+        board->sync();
+        board->mode_history.clear();
+        board->events.schedule(sync_event, clk.clock_cpu + cycles_per_sync);
+    };
+    board->events.schedule(sync_event, clk.clock_cpu + cycles_per_sync);
+    clk_t typing_resumes = 0;
+    const char *reason = nullptr;
+
+    while(!reason) {
+        if(options.cycles && (clk.clock_cpu >= options.cycles)) {
+            reason = "cycle limit";
+            break;
+        }
+        if(!script.empty() && (clk.clock_cpu >= typing_resumes) && board->keyboard_buffer.empty()) {
+            const scripted_key& k = script.front();
+            if(k.wait) {
+                typing_resumes = clk.clock_cpu + k.cycles;
+            } else {
+                machine.apply_input(input_event(clk.clock_cpu, input_event::KEY, k.key));
+            }
+            script.pop_front();
+        }
+        if(machine.replaying) {
+            machine.replay_inputs();
+            if(machine.replay_finished()) {
+                reason = "replay finished";
+                break;
+            }
+        }
+
+        // Translated blocks can run past the stop address, and replayed
+        // inputs must land on their exact cycle, so step one instruction
+        // at a time when either might be near
+        if((options.until_pc >= 0) || (machine.next_replay_clock() - clk.clock_cpu <= cpu.max_cycles_per_cycle)) {
+            machine.step();
+            if(cpu.pc == options.until_pc) {
+                reason = "PC reached";
+            }
+        } else if(script.empty() && (options.until_mem_address < 0)) {
+            // Nothing to look at between instructions, so run until the
+            // cycle limit or the next replayed input needs attention
+            clk_t stop = machine.next_replay_clock() - cpu.max_cycles_per_cycle;
+            if(options.cycles) {
+                stop = std::min(stop, options.cycles);
+            }
+            machine.run_until(stop);
+        } else {
+            cpu.cycle();
+            machine.run_due_events();
+        }
+        if((options.until_mem_address >= 0) && (board->peek(options.until_mem_address) == options.until_mem_value)) {
+            reason = "memory matched";
+        }
+    }
+    board->events.cancel(sync_event);
+    return reason;
+}
+
+// Print why a headless run stopped and its text screen, and write the
+// dump files and save state if asked for
+bool report_headless(apple2e_instance& machine, const char *reason, const headless_options& options, FILE *fp)
+{
+    MAINboard *board = machine.board;
+
+    fprintf(fp, "stopped (%s) at PC %04X after %llu cycles\n", reason, machine.cpu.pc, (unsigned long long)machine.clk.clock_cpu);
+    dump_text_page(board, fp);
+
+    if(options.dump_prefix) {
+        string text_name = string(options.dump_prefix) + ".txt";
+        FILE *text_fp = fopen(text_name.c_str(), "w");
+        if(text_fp == NULL) {
+            fprintf(stderr, "failed to open %s for writing\n", text_name.c_str());
+            return false;
+        }
+        dump_text_page(board, text_fp);
+        fclose(text_fp);
+
+        vector<uint8_t> memory(65536);
+        for(int addr = 0; addr < 65536; addr++) {
+            memory[addr] = board->peek(addr);
+        }
+        vector<uint8_t> hires(board->hires_page1.memory.size());
+        board->hires_page1.memory.copy_out(hires.data());
+        if(!dump_to_file(options.dump_prefix, ".hgr", hires.data(), hires.size()) ||
+            !dump_to_file(options.dump_prefix, ".mem", memory.data(), memory.size())) {
+            return false;
+        }
+
+        using APPLE2Einterface::video_frame_width;
+        using APPLE2Einterface::video_frame_height;
+        vector<uint8_t> pixels(video_frame_width * video_frame_height);
+        render_screen(board, true, pixels.data());
+        char header[32];
+        int header_size = snprintf(header, sizeof(header), "P6 %d %d 255\n", video_frame_width, video_frame_height);
+        vector<uint8_t> ppm(header, header + header_size);
+        ppm.resize(header_size + pixels.size() * 3);
+        APPLE2Einterface::video_pixels_to_rgb(pixels.data(), ppm.data() + header_size);
+        if(!dump_to_file(options.dump_prefix, ".ppm", ppm.data(), ppm.size())) {
+            return false;
+        }
+    }
+    if(options.save_state_name && !machine.save_state(options.save_state_name)) {
+        return false;
+    }
+    if(machine.cpu.jit_verify) {
+        fprintf(fp, "checked %llu translated block runs against the interpreter (%llu not checkable), %llu mismatched\n",
+            (unsigned long long)machine.cpu.verified_blocks, (unsigned long long)machine.cpu.unverified_blocks, (unsigned long long)machine.cpu.verify_mismatches);
+        if(machine.cpu.verify_mismatches > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// "-", "none", or an empty name mean no floppy in the drive
+const char *floppy_name_or_null(const char *name)
+{
+    if((strcmp(name, "-") == 0) || (strcmp(name, "none") == 0) || (strcmp(name, "") == 0))
+        return NULL;
+    return name;
+}
+
+// Parse one of the options shared by -headless and -jobs lines.  Returns
+// the number of arguments used, or 0 if argv[0] isn't one of them.
+int parse_headless_option(int argc, char **argv, headless_options& options)
+{
+    if(strcmp(argv[0], "-cycles") == 0) {
+        if(argc < 2) {
+            fprintf(stderr, "-cycles option requires a cycle count.\n");
+            exit(EXIT_FAILURE);
+        }
+        options.cycles = strtoull(argv[1], NULL, 0);
+        return 2;
+    } else if(strcmp(argv[0], "-until-pc") == 0) {
+        if(argc < 2) {
+            fprintf(stderr, "-until-pc option requires an address.\n");
+            exit(EXIT_FAILURE);
+        }
+        options.until_pc = strtoul(argv[1], NULL, 0) & 0xFFFF;
+        return 2;
+    } else if(strcmp(argv[0], "-until-mem") == 0) {
+        if(argc < 3) {
+            fprintf(stderr, "-until-mem option requires an address and a byte value.\n");
+            exit(EXIT_FAILURE);
+        }
+        options.until_mem_address = strtoul(argv[1], NULL, 0) & 0xFFFF;
+        options.until_mem_value = strtoul(argv[2], NULL, 0);
+        return 3;
+    } else if(strcmp(argv[0], "-keys") == 0) {
+        if(argc < 2) {
+            fprintf(stderr, "-keys option requires a key script filename.\n");
+            exit(EXIT_FAILURE);
+        }
+        options.keys_name = argv[1];
+        return 2;
+    } else if(strcmp(argv[0], "-replay") == 0) {
+        if(argc < 2) {
+            fprintf(stderr, "-replay option requires an input log filename.\n");
+            exit(EXIT_FAILURE);
+        }
+        options.replay_name = argv[1];
+        return 2;
+    } else if(strcmp(argv[0], "-dump") == 0) {
+        if(argc < 2) {
+            fprintf(stderr, "-dump option requires a filename prefix.\n");
+            exit(EXIT_FAILURE);
+        }
+        options.dump_prefix = argv[1];
+        return 2;
+    } else if(strcmp(argv[0], "-save-state") == 0) {
+        if(argc < 2) {
+            fprintf(stderr, "-save-state option requires a filename.\n");
+            exit(EXIT_FAILURE);
+        }
+        options.save_state_name = argv[1];
+        return 2;
+    }
+    return 0;
+}
+
+// One machine's worth of work from a -jobs file
+struct headless_job
+{
+    headless_options options;
+    const char *floppy_names[2] = {nullptr, nullptr};
+};
+
+// Each line of a jobs file is headless options followed by up to two
+// floppy image names, e.g. "-keys build.txt -dump out/build build.dsk -".
+// Blank lines and lines starting with "#" are skipped.  The names point
+// into words, which must outlive the jobs.
+bool read_jobs_file(const char *name, deque<string>& words, vector<headless_job>& jobs)
+{
+    FILE *fp = fopen(name, "r");
+    if(fp == NULL) {
+        fprintf(stderr, "failed to open %s for reading\n", name);
+        return false;
+    }
+    char line[1024];
+    int line_number = 0;
+    while(fgets(line, sizeof(line), fp) != NULL) {
+        line_number++;
+        vector<char*> args;
+        for(char *word = strtok(line, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n")) {
+            words.push_back(word);
+            args.push_back(&words.back()[0]);
+        }
+        if(args.empty() || (args[0][0] == '#')) {
+            continue;
+        }
+
+        headless_job job;
+        int argc = args.size();
+        char **argv = args.data();
+        while((argc > 0) && (argv[0][0] == '-') && (argv[0][1] != '\0')) {
+            int used = parse_headless_option(argc, argv, job.options);
+            if(used == 0) {
+                fprintf(stderr, "%s:%d: unknown parameter \"%s\"\n", name, line_number, argv[0]);
+                fclose(fp);
+                return false;
+            }
+            argc -= used;
+            argv += used;
+        }
+        if(argc > 2) {
+            fprintf(stderr, "%s:%d: expected at most two floppy image names\n", name, line_number);
+            fclose(fp);
+            return false;
+        }
+        if(!job.options.has_stop_condition()) {
+            fprintf(stderr, "%s:%d: a job needs -cycles, -until-pc, -until-mem, or -replay to stop\n", name, line_number);
+            fclose(fp);
+            return false;
+        }
+        for(int i = 0; i < argc; i++) {
+            job.floppy_names[i] = floppy_name_or_null(argv[i]);
+        }
+        jobs.push_back(job);
+    }
+    fclose(fp);
+    return true;
+}
+
+apple2e_instance *new_headless_machine(const uint8_t rom_image[32768], const uint8_t *diskII_rom, const char *floppy0_name, const char *floppy1_name, bool decode_cache, bool jit, bool jit_verify, bool fast_disk)
+{
+    apple2e_instance *machine = new apple2e_instance(rom_image,
+        [](uint16_t addr, bool aux, uint8_t data, clk_t when)->bool{return true;},
+        [](int16_t *buf, size_t sz){ },
+        [](int num)->tuple<float, bool>{return APPLE2Einterface::get_paddle(num);});
+    if(diskII_rom) {
+        machine->install_diskII(diskII_rom, floppy0_name, floppy1_name, [](int num, bool activity){});
+    }
+    machine->cpu.set_decode_cache(decode_cache);
+    machine->cpu.set_jit(jit, jit_verify);
+    if(fast_disk && machine->diskII) {
+        machine->enable_fast_disk();
+    }
+    return machine;
+}
+
+// Run each job on its own machine, with up to thread_count machines running
+// at once.  A job's report is printed whole when it finishes, numbered by
+// its order in the jobs file.  Jobs starting from a save state are forked
+// from one machine that loaded it, so they share its memory until they
+// write to it.
+bool run_headless_jobs(const vector<headless_job>& jobs, int thread_count, const uint8_t rom_image[32768], const uint8_t *diskII_rom, const char *load_state_name, bool decode_cache, bool jit, bool jit_verify, bool fast_disk)
+{
+    atomic<size_t> next_job(0);
+    atomic<bool> succeeded(true);
+    mutex report_lock;
+    mutex fork_lock;
+
+    apple2e_instance *start = nullptr;
+    if(load_state_name) {
+        start = new_headless_machine(rom_image, diskII_rom, NULL, NULL, decode_cache, jit, jit_verify, fast_disk);
+        if(!start->load_state(load_state_name)) {
+            delete start;
+            return false;
+        }
+    }
+
+    auto worker = [&]() {
+        for(size_t i = next_job++; i < jobs.size(); i = next_job++) {
+            const headless_job& job = jobs[i];
+            apple2e_instance *machine;
+            if(start) {
+                lock_guard<mutex> lock(fork_lock);
+                machine = start->fork();
+            } else {
+                machine = new_headless_machine(rom_image, diskII_rom, job.floppy_names[0], job.floppy_names[1], decode_cache, jit, jit_verify, fast_disk);
+            }
+
+            const char *reason = run_headless(*machine, job.options);
+
+            {
+                lock_guard<mutex> lock(report_lock);
+                printf("job %zu: ", i + 1);
+                if(!reason) {
+                    printf("failed\n");
+                    succeeded = false;
+                } else if(!report_headless(*machine, reason, job.options, stdout)) {
+                    succeeded = false;
+                }
+                fflush(stdout);
+            }
+            delete machine;
+        }
+    };
+
+    vector<thread> threads;
+    for(int i = 0; i < thread_count; i++) {
+        threads.push_back(thread(worker));
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+    delete start;
+    return succeeded;
+}
+
 int main(int argc, char **argv)
 {
     const char *progname = argv[0];
@@ -2281,6 +5585,20 @@ int main(int argc, char **argv)
     const char *diskII_rom_name = NULL, *floppy1_name = NULL, *floppy2_name = NULL;
     const char *map_name = NULL;
     bool mute = false;
+    bool decode_cache = false;
+    bool jit = false;
+    bool jit_verify = false;
+    bool fast_disk = false;
+    bool headless = false;
+    headless_options headless_config;
+    const char *jobs_name = NULL;
+    const char *load_state_name = NULL;
+    const char *record_name = NULL;
+    bool record_video = false;
+    APPLE2Einterface::VideoFormat video_format = APPLE2Einterface::VIDEO_GIF;
+    int rewind_millis = 0;
+    int rewind_count = 0;
+    int thread_count = thread::hardware_concurrency();
 
     while((argc > 0) && (argv[0][0] == '-')) {
 	if(strcmp(argv[0], "-mute") == 0) {
@@ -2309,6 +5627,93 @@ int main(int argc, char **argv)
             run_fast = true;
             argv += 1;
             argc -= 1;
+	} else if(strcmp(argv[0], "-warp-disk") == 0) {
+            warp_while_disk_motor_on = true;
+            argv += 1;
+            argc -= 1;
+	} else if(strcmp(argv[0], "-decode-cache") == 0) {
+            decode_cache = true;
+            argv += 1;
+            argc -= 1;
+	} else if(strcmp(argv[0], "-fast-disk") == 0) {
+            fast_disk = true;
+            argv += 1;
+            argc -= 1;
+	} else if(strcmp(argv[0], "-jit") == 0) {
+            jit = true;
+            argv += 1;
+            argc -= 1;
+	} else if(strcmp(argv[0], "-jit-verify") == 0) {
+            jit = true;
+            jit_verify = true;
+            argv += 1;
+            argc -= 1;
+	} else if(strcmp(argv[0], "-headless") == 0) {
+            headless = true;
+            argv += 1;
+            argc -= 1;
+	} else if(strcmp(argv[0], "-jobs") == 0) {
+            if(argc < 2) {
+                fprintf(stderr, "-jobs option requires a jobs filename.\n");
+                exit(EXIT_FAILURE);
+            }
+            jobs_name = argv[1];
+            argv += 2;
+            argc -= 2;
+	} else if(strcmp(argv[0], "-load-state") == 0) {
+            if(argc < 2) {
+                fprintf(stderr, "-load-state option requires a filename.\n");
+                exit(EXIT_FAILURE);
+            }
+            load_state_name = argv[1];
+            argv += 2;
+            argc -= 2;
+	} else if(strcmp(argv[0], "-record") == 0) {
+            if(argc < 2) {
+                fprintf(stderr, "-record option requires an input log filename.\n");
+                exit(EXIT_FAILURE);
+            }
+            record_name = argv[1];
+            argv += 2;
+            argc -= 2;
+	} else if(strcmp(argv[0], "-rewind") == 0) {
+            if(argc < 3) {
+                fprintf(stderr, "-rewind option requires a checkpoint interval in milliseconds and a checkpoint count.\n");
+                exit(EXIT_FAILURE);
+            }
+            rewind_millis = atoi(argv[1]);
+            rewind_count = atoi(argv[2]);
+            argv += 3;
+            argc -= 3;
+	} else if(strcmp(argv[0], "-threads") == 0) {
+            if(argc < 2) {
+                fprintf(stderr, "-threads option requires a thread count.\n");
+                exit(EXIT_FAILURE);
+            }
+            thread_count = atoi(argv[1]);
+            argv += 2;
+            argc -= 2;
+	} else if(int used = parse_headless_option(argc, argv, headless_config)) {
+            argv += used;
+            argc -= used;
+	} else if(strcmp(argv[0], "-video") == 0) {
+            if(argc < 2) {
+                fprintf(stderr, "-video option requires a format, gif, y4m, or ppm.\n");
+                exit(EXIT_FAILURE);
+            }
+            if(strcmp(argv[1], "gif") == 0) {
+                video_format = APPLE2Einterface::VIDEO_GIF;
+            } else if(strcmp(argv[1], "y4m") == 0) {
+                video_format = APPLE2Einterface::VIDEO_Y4M;
+            } else if(strcmp(argv[1], "ppm") == 0) {
+                video_format = APPLE2Einterface::VIDEO_PPM;
+            } else {
+                fprintf(stderr, "unknown video format \"%s\", expected gif, y4m, or ppm.\n", argv[1]);
+                exit(EXIT_FAILURE);
+            }
+            record_video = true;
+            argv += 2;
+            argc -= 2;
 	} else if(strcmp(argv[0], "-d") == 0) {
             debug = atoi(argv[1]);
             if(argc < 2) {
@@ -2357,64 +5762,103 @@ int main(int argc, char **argv)
             exit(EXIT_FAILURE);
     }
 
+    // Replay runs flat out with no window
+    if(headless_config.replay_name != NULL)
+        headless = true;
+
+    if(headless && (jobs_name == NULL) && !headless_config.has_stop_condition()) {
+        fprintf(stderr, "-headless needs -cycles, -until-pc, -until-mem, or -replay to stop\n");
+        exit(EXIT_FAILURE);
+    }
+
     if(map_name != NULL) {
         if(!read_map(map_name))
             exit(EXIT_FAILURE);
     }
 
-    MAINboard* mainboard;
+    if(jobs_name != NULL) {
+        deque<string> words;
+        vector<headless_job> jobs;
+        if(!read_jobs_file(jobs_name, words, jobs))
+            exit(EXIT_FAILURE);
+        exit(run_headless_jobs(jobs, max(thread_count, 1), b, (diskII_rom_name != NULL) ? diskII_rom : NULL, load_state_name, decode_cache, jit, jit_verify, fast_disk) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
 
-    MAINboard::display_write_func display = [](uint16_t addr, bool aux, uint8_t data)->bool{return APPLE2Einterface::write(addr, aux, data);};
+    MAINboard::display_write_func display;
+    if(headless)
+        display = [](uint16_t addr, bool aux, uint8_t data, clk_t when)->bool{return true;};
+    else
+        display = [](uint16_t addr, bool aux, uint8_t data, clk_t when)->bool{return APPLE2Einterface::write(addr, aux, data, when);};
 
     MAINboard::get_paddle_func paddle = [](int num)->tuple<float, bool>{return APPLE2Einterface::get_paddle(num);};
 
     MAINboard::audio_flush_func audio;
-    if(mute)
-        audio = [](uint8_t *buf, size_t sz){ };
+    if(mute || headless)
+        audio = [](int16_t *buf, size_t sz){ };
     else
-        audio = [](uint8_t *buf, size_t sz){ if(!run_fast) APPLE2Einterface::enqueue_audio_samples(buf, sz); };
+        audio = [](int16_t *buf, size_t sz){ if(!run_fast && !disk_warping) APPLE2Einterface::enqueue_audio_samples(buf, sz); };
 
-    mainboard = new MAINboard(clk, b, display, audio, paddle);
-    bus.board = mainboard;
-    bus.reset();
+    apple2e_instance machine(b, display, audio, paddle);
+    MAINboard* mainboard = machine.board;
+    bus_frontend& bus = machine.bus;
+    system_clock& clk = machine.clk;
+    auto& cpu = machine.cpu;
 
     if(diskII_rom_name != NULL) {
 
-        if((strcmp(floppy1_name, "-") == 0) || 
-           (strcmp(floppy1_name, "none") == 0) || 
-           (strcmp(floppy1_name, "") == 0) )
-            floppy1_name = NULL;
-
-        if((strcmp(floppy2_name, "-") == 0) || 
-           (strcmp(floppy2_name, "none") == 0) || 
-           (strcmp(floppy2_name, "") == 0) )
-            floppy2_name = NULL;
+        floppy1_name = floppy_name_or_null(floppy1_name);
+        floppy2_name = floppy_name_or_null(floppy2_name);
 
         try {
-            DISKIIboard::floppy_activity_func activity = [](int num, bool activity){APPLE2Einterface::show_floppy_activity(num, activity);};
-            diskIIboard = new (std::nothrow) DISKIIboard(diskII_rom, floppy1_name, floppy2_name, activity);
-            if(!diskIIboard) {
-                printf("failed to new DISKIIboard\n");
-            }
-            mainboard->boards.push_back(diskIIboard);
-            mockingboard = new Mockingboard();
-            mainboard->boards.push_back(mockingboard);
+            DISKIIboard::floppy_activity_func activity;
+            if(headless)
+                activity = [](int num, bool activity){};
+            else
+                activity = [](int num, bool activity){APPLE2Einterface::show_floppy_activity(num, activity);};
+            machine.install_diskII(diskII_rom, floppy1_name, floppy2_name, activity);
         } catch(const char *msg) {
             cerr << msg << endl;
             exit(EXIT_FAILURE);
         }
     }
 
-    CPU6502<system_clock, bus_frontend> cpu(clk, bus);
+    cpu.set_decode_cache(decode_cache);
+    cpu.set_jit(jit, jit_verify);
+    if(fast_disk && machine.diskII) {
+        machine.enable_fast_disk();
+    }
+
+    if(load_state_name && !machine.load_state(load_state_name)) {
+        exit(EXIT_FAILURE);
+    }
+
+    if(record_name && !machine.start_recording(record_name)) {
+        exit(EXIT_FAILURE);
+    }
+
+    if((rewind_millis > 0) && (rewind_count > 0)) {
+        machine.enable_rewind((clk_t)rewind_millis * machine_clock_rate / 14 / 1000, rewind_count);
+    }
 
     atexit(cleanup);
 
 #ifdef SUPPORT_FAKE_6502
+    fake6502_bus = &bus;
     if(use_fake6502)
         reset6502();
 #endif
 
+    if(headless) {
+        const char *reason = run_headless(machine, headless_config);
+        machine.stop_recording();
+        machine.flush_floppies();
+        exit((reason && report_headless(machine, reason, headless_config, stdout)) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
     APPLE2Einterface::start(run_fast, diskII_rom_name != NULL, floppy1_name != NULL, floppy2_name != NULL);
+    if(record_video) {
+        APPLE2Einterface::record_video(video_format);
+    }
 
     chrono::time_point<chrono::system_clock> then = std::chrono::system_clock::now();
     chrono::time_point<chrono::system_clock> cpu_speed_then = std::chrono::system_clock::now();
@@ -2426,9 +5870,14 @@ int main(int argc, char **argv)
     while(1) {
         if(!debugging) {
 
-            if(process_events(mainboard, bus, cpu) == APPLE2Einterface::QUIT) {
+            if(process_events(machine) == APPLE2Einterface::QUIT) {
                 break;
             }
+            machine.checkpoint_if_due();
+
+            // With -warp-disk, slices run flat out and silent while a
+            // drive motor is on, so floppies load without the wait
+            disk_warping = warp_while_disk_motor_on && !run_fast && machine.diskII && machine.diskII->motorOn();
 
             uint32_t clocks_per_slice;
             if(pause_cpu)
@@ -2436,14 +5885,22 @@ int main(int argc, char **argv)
             else {
                 if(run_rate_limited) {
                     clocks_per_slice = machine_clock_rate / 1000 * rate_limit_millis; 
-                } else if(run_fast) {
+                } else if(run_fast || disk_warping) {
                     clocks_per_slice = machine_clock_rate / 5; 
                 } else {
                     clocks_per_slice = millis_per_slice * machine_clock_rate / 1000 * 1.05;
                 }
             }
-            clk_t prev_clock = clk;
-            while(clk - prev_clock < clocks_per_slice) {
+            clk_t slice_end = clk.clock_cpu + (clk_t)clocks_per_slice * 65 / 912; // in CPU cycles
+            machine.idle_skip_limit = slice_end;
+            bool tracing = debug & (DEBUG_DECODE | DEBUG_STATE | DEBUG_CLOCK);
+#ifdef SUPPORT_FAKE_6502
+            tracing = tracing || use_fake6502;
+#endif
+            if(!tracing) {
+                machine.run_until(slice_end);
+            }
+            while(clk.clock_cpu < slice_end) {
                 if(debug & DEBUG_DECODE) {
                     string dis = read_bus_and_disassemble(bus,
 #ifdef SUPPORT_FAKE_6502
@@ -2468,28 +5925,31 @@ int main(int argc, char **argv)
                 if(debug & DEBUG_CLOCK) {
                     printf("clock = %u, %u\n", (uint32_t)(clk / (1LLU << 32)), (uint32_t)(clk % (1LLU << 32)));
                 }
+                machine.run_due_events();
             }
             mainboard->sync();
+            machine.watch_for_idle_loop();
 
             chrono::time_point<chrono::system_clock> cpu_speed_now = std::chrono::system_clock::now();
 
             auto cpu_elapsed_seconds = chrono::duration_cast<chrono::duration<float> >(cpu_speed_now - cpu_speed_then);
             cpu_speed_then = cpu_speed_now;
 
-            clk_t cpu_elapsed_cycles = clk.clock_cpu - cpu_previous_cycles;
+            // The clock goes backwards if an older state was loaded
+            clk_t cpu_elapsed_cycles = (clk.clock_cpu > cpu_previous_cycles) ? (clk.clock_cpu - cpu_previous_cycles) : 0;
             cpu_previous_cycles = clk.clock_cpu;
 
             float cpu_speed = cpu_elapsed_cycles / cpu_elapsed_seconds.count();
             cpu_speed_averaged.add(cpu_speed);
 
-            APPLE2Einterface::iterate(mode_history, clk.clock_cpu, cpu_speed_averaged.get() / 1000000.0f);
-            mode_history.clear();
+            APPLE2Einterface::iterate(mainboard->mode_history, clk.clock_cpu, cpu_speed_averaged.get() / 1000000.0f);
+            mainboard->mode_history.clear();
 
             chrono::time_point<chrono::system_clock> now = std::chrono::system_clock::now();
 
             auto elapsed_millis = chrono::duration_cast<chrono::milliseconds>(now - then);
 
-            if(!run_fast || pause_cpu) {
+            if(!(run_fast || disk_warping) || pause_cpu) {
                 this_thread::sleep_for(chrono::milliseconds(clocks_per_slice * 1000 / machine_clock_rate) - elapsed_millis);
             }
 
@@ -2501,6 +5961,8 @@ int main(int argc, char **argv)
             printf("> ");
             char line[512];
             if(fgets(line, sizeof(line) - 1, stdin) == NULL) {
+                machine.stop_recording();
+                machine.flush_floppies();
 		exit(0);
 	    }
             line[strlen(line) - 1] = '\0';
@@ -2538,18 +6000,38 @@ int main(int argc, char **argv)
                 sscanf(line + 6, "%u", &debug);
                 printf("debug set to %02X\n", debug);
                 continue;
+            } else if(strncmp(line, "save ", 5) == 0) {
+                if(machine.save_state(line + 5)) {
+                    printf("saved state to %s\n", line + 5);
+                }
+                continue;
+            } else if(strncmp(line, "load ", 5) == 0) {
+                machine.apply_input(input_event(clk.clock_cpu, input_event::LOAD_STATE, 0, line + 5));
+                continue;
             } else if(strcmp(line, "reset") == 0) {
                 printf("machine reset.\n");
-                bus.reset();
-                cpu.reset();
+                machine.apply_input(input_event(clk.clock_cpu, input_event::RESET));
                 continue;
             } else if(strcmp(line, "reboot") == 0) {
                 printf("CPU rebooted (NMI).\n");
                 bus.reset();
                 cpu.nmi();
                 continue;
+            } else if(strcmp(line, "rewind") == 0) {
+                if(machine.checkpoints.empty()) {
+                    printf("no checkpoints to rewind to (see -rewind)\n");
+                } else {
+                    printf("can rewind to cycles %llu through %llu\n", (unsigned long long)machine.checkpoints.front().clock, (unsigned long long)clk.clock_cpu);
+                }
+                continue;
+            } else if(strncmp(line, "rewind ", 7) == 0) {
+                if(machine.rewind_to(strtoull(line + 7, NULL, 0))) {
+                    printf("rewound to cycle %llu, PC %04X\n", (unsigned long long)clk.clock_cpu, cpu.pc);
+                }
+                continue;
             }
             for(int i = 0; i < steps; i++) {
+                machine.checkpoint_if_due();
                 if(debug & DEBUG_DECODE) {
                     string dis = read_bus_and_disassemble(bus,
 #ifdef SUPPORT_FAKE_6502
@@ -2567,7 +6049,7 @@ int main(int argc, char **argv)
                 } else
 #endif
                 {
-                    cpu.cycle();
+                    machine.step();
                     if(debug & DEBUG_STATE)
                         print_cpu_state(cpu);
                 }
@@ -2575,8 +6057,8 @@ int main(int argc, char **argv)
                     mainboard->sync();
                 }
                 if((i % 100000) == 0) {
-                    APPLE2Einterface::iterate(mode_history, clk.clock_cpu, 1.023);
-                    mode_history.clear();
+                    APPLE2Einterface::iterate(mainboard->mode_history, clk.clock_cpu, 1.023);
+                    mainboard->mode_history.clear();
                 }
 
                 uint16_t pcnow = 
@@ -12,6 +12,22 @@
     BUS template parameter must provide methods:
         uint8_t read(uint16_t addr);
         void write(uint16_t addr, uint8_t data);
+
+    BUS may also provide, for use by the decoded instruction cache:
+        uint32_t page_map_generation(int page); - changes whenever the
+            256-byte page could read back different memory (e.g. bank
+            switching), but needn't when the same bytes move elsewhere
+    Without it the cache assumes the memory map never changes.
+
+    BUS may also provide, for maskable interrupts:
+        bool irq_asserted(); - true while a device holds IRQ low; checked
+            before each instruction while the I flag is clear
+
+    Decoded instruction cache:
+        set_decode_cache(bool enabled) - replay decoded opcodes and
+            operands instead of fetching them over the bus
+        invalidate_decode_cache() - forget all decoded instructions, for
+            memory changed without CPU writes
 */
 
 // verify timing
@@ -27,6 +43,7 @@
 
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
 #include <vector>
 
 #ifndef EMULATE_65C02
@@ -58,6 +75,143 @@ struct CPU6502
         INT,
     } exception;
 
+    // Instructions are decoded into this cache the first time they're
+    // executed by recording the opcode and the operand bytes read through
+    // read_pc_inc().  Later executions replay them, charging the same
+    // cycles, without going to the bus.  A page is thrown away when the CPU
+    // writes to it or when the bus reports that page's mapping has changed.
+    // $C000-$CFFF is never cached since reads there may have side effects.
+    struct decoded_instruction
+    {
+        uint8_t length; // 0 if not decoded
+        uint8_t bytes[3];
+    };
+    struct decoded_page
+    {
+        bool valid;
+        uint32_t generation;
+        decoded_instruction instructions[256];
+    };
+    std::vector<decoded_page> decoded_pages;
+    bool decode_cache_enabled = false;
+    decoded_instruction *recording = nullptr;
+    const uint8_t *replaying = nullptr;
+    int replay_remaining = 0;
+
+    // Counts of CPU writes to each page and of whole-cache invalidations,
+    // so translations of code (see cpu6502_jit.h) can tell they're stale
+    uint32_t page_writes[256] = {};
+    uint32_t decode_cache_flushes = 0;
+
+    template <class B>
+    static auto page_map_generation(B& b, int page, int) -> decltype(b.page_map_generation(page))
+    {
+        return b.page_map_generation(page);
+    }
+
+    template <class B>
+    static uint32_t page_map_generation(B& b, int page, long)
+    {
+        return 0;
+    }
+
+    template <class B>
+    static auto irq_asserted(B& b, int) -> decltype(b.irq_asserted())
+    {
+        return b.irq_asserted();
+    }
+
+    template <class B>
+    static bool irq_asserted(B& b, long)
+    {
+        return false;
+    }
+
+    // Take an interrupt before the next instruction if IRQ is low and
+    // interrupts are enabled
+    void check_irq()
+    {
+        if((exception == NONE) && !isset(I) && irq_asserted(bus, 0)) {
+            exception = INT;
+        }
+    }
+
+    void set_decode_cache(bool enabled)
+    {
+        decode_cache_enabled = enabled;
+        decoded_pages.resize(enabled ? 256 : 0);
+        invalidate_decode_cache();
+    }
+
+    void invalidate_decode_cache()
+    {
+        decode_cache_flushes++;
+        for(auto& page : decoded_pages) {
+            page.valid = false;
+        }
+    }
+
+    void invalidate_decoded_page(uint16_t address)
+    {
+        page_writes[address / 256]++;
+        if(decode_cache_enabled) {
+            decoded_pages[address / 256].valid = false;
+        }
+    }
+
+    static bool decodable_page(int page)
+    {
+        return (page < 0xC0) || (page > 0xCF);
+    }
+
+    // Fetch the opcode at pc, setting up replay of its operands if it was
+    // decoded before or recording of its operands if not
+    uint8_t fetch_instruction()
+    {
+        recording = nullptr;
+        replay_remaining = 0;
+
+        if(!decode_cache_enabled || !decodable_page(pc / 256)) {
+            return read_pc_inc();
+        }
+
+        decoded_page& page = decoded_pages[pc / 256];
+        uint32_t generation = page_map_generation(bus, pc / 256, 0);
+        if(!page.valid || (page.generation != generation)) {
+            memset(page.instructions, 0, sizeof(page.instructions));
+            page.valid = true;
+            page.generation = generation;
+        }
+
+        decoded_instruction& decoded = page.instructions[pc % 256];
+        if(decoded.length > 0) {
+            replaying = decoded.bytes + 1;
+            replay_remaining = decoded.length - 1;
+            clk.add_cpu_cycles(1);
+            pc++;
+            return decoded.bytes[0];
+        }
+
+        uint8_t inst = read_pc_inc();
+        recording = &decoded;
+        recording->bytes[0] = inst;
+        recording->length = 1;
+        return inst;
+    }
+
+    // Keep the instruction just recorded if it was entirely within one
+    // page and didn't write to its own page along the way
+    void finish_instruction(uint16_t inst_pc)
+    {
+        if(recording) {
+            bool complete = ((inst_pc % 256) + recording->length <= 256) && decoded_pages[inst_pc / 256].valid;
+            if(!complete) {
+                recording->length = 0;
+            }
+            recording = nullptr;
+        }
+    }
+
     // XXX For debugging, normally couldn't set CPU PC directly
     void set_pc(uint16_t addr)
     {
@@ -74,6 +228,7 @@ struct CPU6502
     void write(uint16_t address, uint8_t value)
     {
         clk.add_cpu_cycles(1);
+        invalidate_decoded_page(address);
         bus.write(address, value);
     }
 
@@ -89,7 +244,17 @@ struct CPU6502
 
     uint8_t read_pc_inc()
     {
-        return read(pc++);
+        if(replay_remaining > 0) {
+            replay_remaining--;
+            clk.add_cpu_cycles(1);
+            pc++;
+            return *replaying++;
+        }
+        uint8_t data = read(pc++);
+        if(recording && (recording->length < 3)) {
+            recording->bytes[recording->length++] = data;
+        }
+        return data;
     }
 
     void flag_change(uint8_t flag, bool v)
@@ -184,25 +349,37 @@ struct CPU6502
         exception = NONE;
     }
 
+    // Interrupts push the address of the instruction they preempt, for
+    // RTI to return to, and take 7 cycles like BRK
     void irq()
     {
-        stack_push((pc - 1) >> 8);
-        stack_push((pc - 1) & 0xFF);
+        stack_push(pc >> 8);
+        stack_push(pc & 0xFF);
         stack_push((p | B2) & ~B);
+        p |= I;
+#if EMULATE_65C02
+        p &= ~D;
+#endif /* EMULATE_65C02 */
         uint8_t low = read(0xFFFE);
         uint8_t high = read(0xFFFF);
         pc = low + high * 256;
+        clk.add_cpu_cycles(2);
         exception = NONE;
     }
 
     void nmi()
     {
-        stack_push((pc - 1) >> 8);
-        stack_push((pc - 1) & 0xFF);
+        stack_push(pc >> 8);
+        stack_push(pc & 0xFF);
         stack_push((p | B2) & ~B);
+        p |= I;
+#if EMULATE_65C02
+        p &= ~D;
+#endif /* EMULATE_65C02 */
         uint8_t low = read(0xFFFA);
         uint8_t high = read(0xFFFB);
         pc = low + high * 256;
+        clk.add_cpu_cycles(2);
         exception = NONE;
     }
 
@@ -356,6 +533,7 @@ struct CPU6502
 
     void cycle()
     {
+        check_irq();
         if(exception == RESET) {
             reset();
         } if(exception == NMI) {
@@ -365,7 +543,8 @@ struct CPU6502
         }
         // BRK is a special case caused directly by an instruction
 
-        uint8_t inst = read_pc_inc();
+        uint16_t inst_pc = pc;
+        uint8_t inst = fetch_instruction();
 
         uint8_t m;
 
@@ -1869,6 +2048,8 @@ struct CPU6502
                 exit(1);
             }
         }
+
+        finish_instruction(inst_pc);
     }
 };
 
@@ -0,0 +1,1277 @@
+/*
+    CPU6502JIT<CLK, BUS> is a CPU6502 that translates frequently executed
+    basic blocks into x86-64 code and runs them in place of the interpreter.
+
+    Public methods, in addition to those of CPU6502:
+        set_jit(bool enabled, bool verify = false) - translate hot blocks
+            (x86-64 Linux only); with verify, check every run of a block
+            against the interpreter, much more slowly (see verify_block())
+        cycle() - run one translated block, or one instruction if there
+            isn't a translation for pc
+        step() - issue exactly one instruction through the interpreter
+        max_cycles_per_cycle - the most CPU cycles one call to cycle() can
+            add, so a caller that must stop at an exact clock can switch to
+            step() in time
+        set_trap(address) - call trap before the instruction at address
+            runs from cycle() or step(); if trap returns true it has done
+            the work of the code there itself and moved pc on
+
+    BUS must additionally provide, for translated code to read memory:
+        uint8_t** read_page_table(); - 256 pointers to the memory backing
+            reads from each page, or nullptr where reads must go to read()
+    Without it nothing is translated.
+
+    BUS may also provide, so events land between the same instructions as
+    they would with the interpreter:
+        uint64_t cycles_until_event(); - CPU cycles until the caller next
+            has something to run between instructions, e.g. a timer that
+            could pull IRQ low
+
+    Translations are exact: the same registers, flags, memory, and cycle
+    counts as the interpreter, instruction by instruction.  Translated code
+    hands back to the interpreter before an instruction that would read
+    $C000-$CFFF or a page without memory behind it, and before ADC or SBC
+    in decimal mode.  Memory is looked up through the page table as the
+    block runs, so a page moved by copy-on-write doesn't invalidate
+    anything.  Writes go through CPU6502::write(), and a block stops after
+    any write that lands on its own page or changes that page's mapping.
+    A block only runs when no exception is pending and it can't reach the
+    next event, loops on itself only while another pass can't either, and
+    stops after PLP and after any write that pulls IRQ low or brings an
+    event within reach, so events and IRQs are taken between the same
+    instructions as with the interpreter.  A block that runs into a trap
+    address without starting there doesn't stop for it.
+*/
+
+#ifndef CPU6502_JIT_H
+#define CPU6502_JIT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <initializer_list>
+#include <functional>
+#include <vector>
+#include <map>
+
+#include "cpu6502.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define CPU6502_JIT_SUPPORTED 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define CPU6502_JIT_SUPPORTED 0
+#endif
+
+template<class CLK, class BUS>
+struct CPU6502JIT : public CPU6502<CLK, BUS>
+{
+    typedef CPU6502<CLK, BUS> interpreter;
+    using interpreter::a;
+    using interpreter::x;
+    using interpreter::y;
+    using interpreter::s;
+    using interpreter::p;
+    using interpreter::pc;
+    using interpreter::clk;
+    using interpreter::bus;
+
+    static constexpr int hot_threshold = 16; // executions before translating
+    static constexpr int max_block_instructions = 64;
+    static constexpr uint32_t max_loop_iterations = 64; // of a block branching to itself
+    static constexpr size_t code_buffer_size = 16 * 1024 * 1024;
+    static constexpr size_t max_block_size = 32 * 1024;
+    static constexpr uint8_t not_translatable = 0xFF;
+
+    // A block looping on itself, then the instruction it bailed at, each
+    // instruction at most 7 cycles plus a page crossing
+    static constexpr uint64_t max_cycles_per_cycle = (max_block_instructions * max_loop_iterations + 1) * 8;
+
+    // The most CPU cycles one pass through a block can take
+    static constexpr uint32_t max_block_cycles = max_block_instructions * 8;
+
+    typedef void (*block_function)(CPU6502JIT *cpu);
+
+    struct translated_page
+    {
+        bool valid;
+        uint32_t writes;
+        uint32_t generation;
+        uint32_t flushes;
+        block_function blocks[256]; // indexed by low byte of block address
+        uint8_t hits[256]; // executions before translation, or not_translatable
+    };
+    std::vector<translated_page> translated_pages;
+    bool jit_enabled = false;
+    uint8_t *code_buffer = nullptr;
+    size_t code_used = 0;
+
+    // State shared with translated code
+    uint8_t **read_table = nullptr;
+    uint32_t pending_cycles = 0;
+    uint32_t loop_budget = 0;
+    uint32_t cycle_budget = 0; // block cycles before the next event
+    uint8_t bailed = 0;
+    uint8_t block_page = 0;
+    uint8_t nz_flags[256];
+    uint32_t block_cycles = 0; // added by the running block so far
+
+    // Checking blocks against the interpreter
+    struct registers
+    {
+        uint8_t a, x, y, s, p;
+        uint16_t pc;
+    };
+    struct block_write
+    {
+        uint16_t address;
+        uint8_t data;
+        uint32_t cycle; // of the block's cycles, counting the write's own
+        uint8_t replaced; // read from address just before the write
+    };
+    bool jit_verify = false;
+    uint64_t verified_blocks = 0;
+    uint64_t unverified_blocks = 0;
+    uint64_t verify_mismatches = 0;
+    std::vector<block_write> block_writes;
+
+    template <class B>
+    static auto read_page_table(B& b, int) -> decltype(b.read_page_table())
+    {
+        return b.read_page_table();
+    }
+
+    template <class B>
+    static uint8_t **read_page_table(B& b, long)
+    {
+        return nullptr;
+    }
+
+    template <class B>
+    static auto cycles_until_event(B& b, int) -> decltype(b.cycles_until_event())
+    {
+        return b.cycles_until_event();
+    }
+
+    template <class B>
+    static uint64_t cycles_until_event(B& b, long)
+    {
+        return UINT64_MAX;
+    }
+
+    CPU6502JIT(CLK& clk_, BUS& bus_) :
+        interpreter(clk_, bus_)
+    {
+        for(int v = 0; v < 256; v++) {
+            nz_flags[v] = ((v == 0) ? interpreter::Z : 0) | ((v & 0x80) ? interpreter::N : 0);
+        }
+    }
+
+    ~CPU6502JIT()
+    {
+#if CPU6502_JIT_SUPPORTED
+        if(code_buffer) {
+            munmap(code_buffer, code_buffer_size);
+        }
+#endif
+    }
+
+    void set_jit(bool enabled, bool verify = false)
+    {
+#if CPU6502_JIT_SUPPORTED
+        if(enabled && !code_buffer) {
+            // Never writable and executable at once; see translate()
+            void *buffer = mmap(nullptr, code_buffer_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(buffer == MAP_FAILED) {
+                fprintf(stderr, "couldn't allocate memory for translated 6502 code, using the interpreter\n");
+                return;
+            }
+            code_buffer = static_cast<uint8_t*>(buffer);
+        }
+        translated_pages.resize(enabled ? 256 : 0);
+        flush_translations();
+        jit_enabled = enabled;
+        jit_verify = enabled && verify;
+#else
+        if(enabled) {
+            fprintf(stderr, "6502 JIT is only supported on x86-64 Linux, using the interpreter\n");
+        }
+#endif
+    }
+
+    std::vector<bool> traps; // empty when no address has a trap
+    std::function<bool(CPU6502JIT&)> trap;
+
+    void set_trap(uint16_t address)
+    {
+        traps.resize(65536);
+        traps[address] = true;
+    }
+
+    bool trapped()
+    {
+        return !traps.empty() && traps[pc] && (this->exception == interpreter::NONE) && trap(*this);
+    }
+
+    void step()
+    {
+        this->check_irq();
+        if(trapped()) {
+            return;
+        }
+        interpreter::cycle();
+    }
+
+    void cycle()
+    {
+        this->check_irq();
+        if(trapped()) {
+            return;
+        }
+#if CPU6502_JIT_SUPPORTED
+        uint64_t until_event = jit_enabled ? cycles_until_event(bus, 0) : 0;
+        if(jit_enabled && (this->exception == interpreter::NONE) && (until_event > max_block_cycles)) {
+            if(block_function block = find_block(pc)) {
+                block_page = pc / 256;
+                loop_budget = max_loop_iterations;
+                cycle_budget = (until_event < UINT32_MAX) ? until_event : UINT32_MAX;
+                registers before = {a, x, y, s, p, pc};
+                block_cycles = 0;
+                block_writes.clear();
+                block(this);
+                clk.add_cpu_cycles(pending_cycles);
+                block_cycles += pending_cycles;
+                pending_cycles = 0;
+                if(jit_verify) {
+                    verify_block(before);
+                }
+                if(bailed) {
+                    // Translated code stopped at an instruction it can't
+                    // handle, so issue that one here
+                    bailed = 0;
+                    interpreter::cycle();
+                }
+                return;
+            }
+        }
+#endif
+        interpreter::cycle();
+    }
+
+#if CPU6502_JIT_SUPPORTED
+
+    void flush_translations()
+    {
+        code_used = 0;
+        for(auto& page : translated_pages) {
+            page.valid = false;
+        }
+    }
+
+    // Set the protection of the pages a block starting at offset can take
+    bool protect_code(size_t offset, int prot)
+    {
+        size_t page_size = sysconf(_SC_PAGESIZE);
+        size_t start = offset / page_size * page_size;
+        size_t end = (offset + max_block_size + page_size - 1) / page_size * page_size;
+        if(end > code_buffer_size) {
+            end = code_buffer_size;
+        }
+        if(mprotect(code_buffer + start, end - start, prot) != 0) {
+            fprintf(stderr, "couldn't change the protection of translated 6502 code\n");
+            return false;
+        }
+        return true;
+    }
+
+    block_function find_block(uint16_t address)
+    {
+        int pagenum = address / 256;
+        translated_page& page = translated_pages[pagenum];
+        uint32_t generation = interpreter::page_map_generation(bus, pagenum, 0);
+        if(!page.valid ||
+            (page.writes != this->page_writes[pagenum]) ||
+            (page.generation != generation) ||
+            (page.flushes != this->decode_cache_flushes)) {
+
+            memset(page.blocks, 0, sizeof(page.blocks));
+            memset(page.hits, 0, sizeof(page.hits));
+            page.valid = true;
+            page.writes = this->page_writes[pagenum];
+            page.generation = generation;
+            page.flushes = this->decode_cache_flushes;
+        }
+
+        int offset = address % 256;
+        if(!page.blocks[offset]) {
+            if((page.hits[offset] == not_translatable) || (++page.hits[offset] < hot_threshold)) {
+                return nullptr;
+            }
+            block_function block = translate(address);
+            if(!block) {
+                page.hits[offset] = not_translatable;
+                return nullptr;
+            }
+            page.blocks[offset] = block;
+        }
+        return page.blocks[offset];
+    }
+
+    // Called from translated code for every write
+    static uint32_t write_from_block(CPU6502JIT *cpu, uint32_t address, uint32_t data)
+    {
+        cpu->clk.add_cpu_cycles(cpu->pending_cycles);
+        cpu->block_cycles += cpu->pending_cycles + 1; // write() adds the last
+        cpu->pending_cycles = 0;
+        if(cpu->jit_verify) {
+            const uint8_t *page = cpu->read_table[address / 256];
+            cpu->block_writes.push_back({uint16_t(address), uint8_t(data), cpu->block_cycles, page ? page[address % 256] : uint8_t(0)});
+        }
+        uint32_t generation = interpreter::page_map_generation(cpu->bus, cpu->block_page, 0);
+        bool irq = interpreter::irq_asserted(cpu->bus, 0);
+        cpu->write(address, data);
+
+        // The write may have scheduled an event sooner, e.g. a VIA timer
+        uint64_t until_event = cycles_until_event(cpu->bus, 0);
+        if(until_event < cpu->cycle_budget - cpu->block_cycles) {
+            cpu->cycle_budget = cpu->block_cycles + until_event;
+        }
+
+        return ((address / 256) == cpu->block_page) ||
+            (interpreter::page_map_generation(cpu->bus, cpu->block_page, 0) != generation) ||
+            (!irq && interpreter::irq_asserted(cpu->bus, 0)) ||
+            (until_event <= max_block_cycles);
+    }
+
+    struct verify_clock
+    {
+        uint32_t cycles = 0;
+        void add_cpu_cycles(int n) { cycles += n; }
+    };
+
+    // Memory as a block found it, for the interpreter to run the block's
+    // instructions over again: what reads see now, with the bytes the
+    // block's writes replaced put back.  A write is seen by later reads
+    // only if the block's last write to that address is seen now, since a
+    // write can go to other memory than reads come from (e.g. RAMWRT).
+    struct verify_bus
+    {
+        uint8_t **table;
+        const verify_clock& clock;
+        std::map<uint16_t, uint8_t> changed;
+        std::map<uint16_t, uint8_t> last_written;
+        std::vector<block_write> writes;
+        bool read_unbacked = false;
+
+        verify_bus(uint8_t **table_, const verify_clock& clock_, const std::vector<block_write>& block_writes) :
+            table(table_),
+            clock(clock_)
+        {
+            for(auto w = block_writes.rbegin(); w != block_writes.rend(); w++) {
+                changed[w->address] = w->replaced;
+            }
+            for(auto& w : block_writes) {
+                last_written[w.address] = w.data;
+            }
+        }
+
+        uint8_t read(uint16_t address)
+        {
+            auto it = changed.find(address);
+            if(it != changed.end()) {
+                return it->second;
+            }
+            if(!table[address / 256]) {
+                read_unbacked = true;
+                return 0x00;
+            }
+            return table[address / 256][address % 256];
+        }
+
+        void write(uint16_t address, uint8_t data)
+        {
+            writes.push_back({address, data, clock.cycles, 0});
+            auto it = last_written.find(address);
+            const uint8_t *page = table[address / 256];
+            if(page && ((it == last_written.end()) || (page[address % 256] == it->second))) {
+                changed[address] = data;
+            }
+        }
+    };
+
+    // With jit_verify, after each run of a block the interpreter issues the
+    // same instructions from the registers the block started with, and the
+    // registers, cycle count, and every write's address, data, and cycle
+    // must come out the same.  A block that wrote to $C000-$CFFF may have
+    // switched memory around under itself, so it isn't checked.
+    void verify_block(const registers& before)
+    {
+        for(auto& w : block_writes) {
+            if((w.address >= 0xC000) && (w.address < 0xD000)) {
+                unverified_blocks++;
+                return;
+            }
+        }
+
+        verify_clock shadow_clock;
+        verify_bus shadow_bus(read_table, shadow_clock, block_writes);
+        CPU6502<verify_clock, verify_bus> shadow(shadow_clock, shadow_bus);
+        shadow.a = before.a;
+        shadow.x = before.x;
+        shadow.y = before.y;
+        shadow.s = before.s;
+        shadow.p = before.p;
+        shadow.pc = before.pc;
+        shadow.exception = shadow.NONE;
+        while((shadow_clock.cycles < block_cycles) && !shadow_bus.read_unbacked) {
+            shadow.cycle();
+        }
+
+        size_t first_different = 0;
+        while((first_different < block_writes.size()) && (first_different < shadow_bus.writes.size())) {
+            const block_write& w = block_writes[first_different];
+            const block_write& v = shadow_bus.writes[first_different];
+            if((w.address != v.address) || (w.data != v.data) || (w.cycle != v.cycle)) {
+                break;
+            }
+            first_different++;
+        }
+        bool same = !shadow_bus.read_unbacked && (shadow_clock.cycles == block_cycles) &&
+            (shadow.a == a) && (shadow.x == x) && (shadow.y == y) && (shadow.s == s) && (shadow.p == p) && (shadow.pc == pc) &&
+            (first_different == block_writes.size()) && (first_different == shadow_bus.writes.size());
+        verified_blocks++;
+        if(same) {
+            return;
+        }
+
+        verify_mismatches++;
+        fprintf(stderr, "translated block at %04X doesn't match the interpreter:\n", before.pc);
+        fprintf(stderr, "    translated:  A=%02X X=%02X Y=%02X S=%02X P=%02X PC=%04X, %u cycles, %zu writes\n",
+            a, x, y, s, p, pc, block_cycles, block_writes.size());
+        fprintf(stderr, "    interpreter: A=%02X X=%02X Y=%02X S=%02X P=%02X PC=%04X, %u cycles, %zu writes%s\n",
+            shadow.a, shadow.x, shadow.y, shadow.s, shadow.p, shadow.pc, shadow_clock.cycles, shadow_bus.writes.size(),
+            shadow_bus.read_unbacked ? ", read memory the block couldn't have" : "");
+        if(first_different < block_writes.size()) {
+            const block_write& w = block_writes[first_different];
+            fprintf(stderr, "    translated write %zu: %02X to %04X at cycle %u\n", first_different, w.data, w.address, w.cycle);
+        }
+        if(first_different < shadow_bus.writes.size()) {
+            const block_write& v = shadow_bus.writes[first_different];
+            fprintf(stderr, "    interpreter write %zu: %02X to %04X at cycle %u\n", first_different, v.data, v.address, v.cycle);
+        }
+    }
+
+    enum Register { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R12 = 12, R13 = 13, R14 = 14, R15 = 15 };
+    enum Condition { CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5 };
+
+    // 6502 registers live in these while a block runs; RBX points to the
+    // CPU and RBP to the bus's read page table
+    static constexpr int REG_A = R12;
+    static constexpr int REG_X = R13;
+    static constexpr int REG_Y = R14;
+    static constexpr int REG_P = R15;
+
+    struct x86_emitter
+    {
+        uint8_t *code;
+        size_t used = 0;
+
+        void byte(uint8_t b) { code[used++] = b; }
+        void word(uint16_t w) { memcpy(code + used, &w, 2); used += 2; }
+        void dword(uint32_t d) { memcpy(code + used, &d, 4); used += 4; }
+
+        void rex(bool wide, int reg, int index, int base, bool byte_reg)
+        {
+            uint8_t prefix = 0x40 | (wide ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((index & 8) ? 0x02 : 0) | ((base & 8) ? 0x01 : 0);
+            if((prefix != 0x40) || byte_reg) {
+                byte(prefix);
+            }
+        }
+
+        // op reg, rm (register to register)
+        void op_rr(std::initializer_list<uint8_t> op, int reg, int rm, bool wide = false, bool byte_reg = false)
+        {
+            rex(wide, reg, 0, rm, byte_reg);
+            for(auto b : op) {
+                byte(b);
+            }
+            byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+        }
+
+        // op reg, [base + index << scale + disp32], index < 0 for none
+        void op_rm(std::initializer_list<uint8_t> op, int reg, int base, int index, int scale, int32_t disp, bool wide = false, bool byte_reg = false)
+        {
+            rex(wide, reg, (index < 0) ? 0 : index, base, byte_reg);
+            for(auto b : op) {
+                byte(b);
+            }
+            if((index < 0) && ((base & 7) != RSP)) {
+                byte(0x80 | ((reg & 7) << 3) | (base & 7));
+            } else {
+                byte(0x84 | ((reg & 7) << 3));
+                byte((scale << 6) | (((index < 0) ? RSP : index) & 7) << 3 | (base & 7));
+            }
+            dword(disp);
+        }
+
+        // 0x81 group: 0 add, 1 or, 4 and, 5 sub, 6 xor, 7 cmp
+        void op_ri(int digit, int rm, uint32_t imm)
+        {
+            op_rr({0x81}, digit, rm);
+            dword(imm);
+        }
+
+        // 0xC1 group: 4 shl, 5 shr
+        void shift(int digit, int rm, uint8_t count)
+        {
+            op_rr({0xC1}, digit, rm);
+            byte(count);
+        }
+
+        void mov(int dst, int src) { op_rr({0x89}, src, dst); }
+        void mov_imm(int dst, uint32_t imm) { rex(false, 0, 0, dst, false); byte(0xB8 + (dst & 7)); dword(imm); }
+        void mov_imm64(int dst, uint64_t imm) { rex(true, 0, 0, dst, false); byte(0xB8 + (dst & 7)); dword(imm); dword(imm >> 32); }
+        void push(int r) { rex(false, 0, 0, r, false); byte(0x50 + (r & 7)); }
+        void pop(int r) { rex(false, 0, 0, r, false); byte(0x58 + (r & 7)); }
+
+        size_t jcc(int cc) { byte(0x0F); byte(0x80 | cc); dword(0); return used - 4; }
+        size_t jmp() { byte(0xE9); dword(0); return used - 4; }
+        void patch(size_t at, size_t target)
+        {
+            int32_t rel = target - (at + 4);
+            memcpy(code + at, &rel, 4);
+        }
+    };
+
+    struct exit_stub
+    {
+        size_t jump;
+        uint16_t pc;
+        int cycles;
+        bool bail; // instruction at pc is left for the interpreter
+    };
+
+    struct block_builder
+    {
+        x86_emitter e;
+        uint8_t **table;
+        uint16_t start;
+        size_t body;
+        int cycles; // cycles not yet added to pending_cycles
+        std::vector<exit_stub> stubs;
+        std::vector<size_t> epilogue_jumps;
+    };
+
+    int32_t offset_of(const void *member) const
+    {
+        return static_cast<const uint8_t*>(member) - reinterpret_cast<const uint8_t*>(this);
+    }
+
+    static bool io_page(int page)
+    {
+        return (page >= 0xC0) && (page <= 0xCF);
+    }
+
+    static bool readable(uint8_t **table, uint16_t address)
+    {
+        return !io_page(address / 256) && table[address / 256];
+    }
+
+    void emit_add_cycles(block_builder& b, int cycles)
+    {
+        if(cycles > 0) {
+            b.e.op_rm({0x81}, 0, RBX, -1, 0, offset_of(&pending_cycles));
+            b.e.dword(cycles);
+        }
+    }
+
+    void emit_flush_cycles(block_builder& b)
+    {
+        emit_add_cycles(b, b.cycles);
+        b.cycles = 0;
+    }
+
+    void emit_exit(block_builder& b, uint16_t to, int cycles, bool bail = false)
+    {
+        b.e.byte(0x66);
+        b.e.op_rm({0xC7}, 0, RBX, -1, 0, offset_of(&pc));
+        b.e.word(to);
+        emit_add_cycles(b, cycles);
+        if(bail) {
+            b.e.op_rm({0xC6}, 0, RBX, -1, 0, offset_of(&bailed));
+            b.e.byte(1);
+        }
+        b.epilogue_jumps.push_back(b.e.jmp());
+    }
+
+    // Leave the block before the instruction at inst_pc if condition holds
+    void emit_bail(block_builder& b, int cc, uint16_t inst_pc, int cycles)
+    {
+        b.stubs.push_back({b.e.jcc(cc), inst_pc, cycles, true});
+    }
+
+    void emit_set_nz(block_builder& b, int reg)
+    {
+        b.e.op_ri(4, REG_P, 0xFF & ~(interpreter::N | interpreter::Z));
+        b.e.op_rm({0x0A}, REG_P, RBX, reg, 0, offset_of(nz_flags), false, true);
+    }
+
+    // RDX = memory behind page as the block runs, bailing if there is none;
+    // looked up each time since copy-on-write and bank switching move it
+    void emit_page_base(block_builder& b, int page, uint16_t inst_pc, int cycles)
+    {
+        b.e.op_rm({0x8B}, RDX, RBP, -1, 0, page * 8, true);
+        b.e.op_rr({0x85}, RDX, RDX, true);
+        emit_bail(b, CC_E, inst_pc, cycles);
+    }
+
+    // EAX = byte at address, which isn't I/O
+    void emit_read_static(block_builder& b, uint16_t address, uint16_t inst_pc, int cycles)
+    {
+        emit_page_base(b, address / 256, inst_pc, cycles);
+        b.e.op_rm({0x0F, 0xB6}, RAX, RDX, -1, 0, address % 256);
+    }
+
+    // EAX = byte at address in ESI, bailing on I/O or unmapped pages
+    void emit_read_dynamic(block_builder& b, uint16_t inst_pc, int cycles)
+    {
+        b.e.mov(RCX, RSI);
+        b.e.op_ri(5, RCX, 0xC000);
+        b.e.op_ri(7, RCX, 0x1000);
+        emit_bail(b, CC_B, inst_pc, cycles);
+        b.e.mov(RCX, RSI);
+        b.e.shift(5, RCX, 8);
+        b.e.op_rm({0x8B}, RDX, RBP, RCX, 3, 0, true);
+        b.e.op_rr({0x85}, RDX, RDX, true);
+        emit_bail(b, CC_E, inst_pc, cycles);
+        b.e.mov(RCX, RSI);
+        b.e.op_ri(4, RCX, 0xFF);
+        b.e.op_rm({0x0F, 0xB6}, RAX, RDX, RCX, 0, 0);
+    }
+
+    // Add a cycle if ESI and EDI are on different pages
+    void emit_page_cross_cycle(block_builder& b)
+    {
+        b.e.mov(RCX, RSI);
+        b.e.op_rr({0x31}, RDI, RCX);
+        b.e.shift(5, RCX, 8);
+        b.e.op_rr({0x0F, 0x90 | CC_NE}, 0, RCX, false, true);
+        b.e.op_rr({0x0F, 0xB6}, RCX, RCX, false, true);
+        b.e.op_rm({0x01}, RCX, RBX, -1, 0, offset_of(&pending_cycles));
+    }
+
+    // Write EDX to the address in ESI, leaving the block afterwards at
+    // next_pc if the write could have changed code or the memory map
+    void emit_write(block_builder& b, uint16_t next_pc, bool may_leave = true)
+    {
+        emit_flush_cycles(b);
+        b.e.op_rr({0x89}, RBX, RDI, true);
+        b.e.mov_imm64(RAX, reinterpret_cast<uint64_t>(&write_from_block));
+        b.e.byte(0xFF);
+        b.e.byte(0xD0);
+        if(may_leave) {
+            b.e.op_rr({0x85}, RAX, RAX);
+            b.stubs.push_back({b.e.jcc(CC_NE), next_pc, 0, false});
+        }
+    }
+
+    // Push EDX
+    void emit_push(block_builder& b, uint16_t next_pc, bool may_leave = true)
+    {
+        b.e.op_rm({0x0F, 0xB6}, RSI, RBX, -1, 0, offset_of(&s));
+        b.e.mov(RCX, RSI);
+        b.e.op_ri(5, RCX, 1);
+        b.e.op_rm({0x88}, RCX, RBX, -1, 0, offset_of(&s), false, true);
+        b.e.op_ri(1, RSI, 0x100);
+        emit_write(b, next_pc, may_leave);
+    }
+
+    // EAX = pulled byte, bailing before anything changes if the stack page
+    // has no memory behind it
+    void emit_pull(block_builder& b, uint16_t inst_pc, int cycles)
+    {
+        emit_page_base(b, 0x01, inst_pc, cycles);
+        b.e.op_rm({0x0F, 0xB6}, RCX, RBX, -1, 0, offset_of(&s));
+        b.e.op_ri(0, RCX, 1);
+        b.e.op_ri(4, RCX, 0xFF);
+        b.e.op_rm({0x88}, RCX, RBX, -1, 0, offset_of(&s), false, true);
+        b.e.op_rm({0x0F, 0xB6}, RAX, RDX, RCX, 0, 0);
+    }
+
+    enum Mode { IMP, ACC, IMM, ZPG, ZPX, ZPY, ABS, ABX, ABY, IZY, IZX, REL };
+    enum Operation {
+        LDA, LDX, LDY, STA, STX, STY, ORA, AND, EOR, ADC, SBC, CMP, CPX, CPY, BIT,
+        INC, DEC, ASL, LSR, ROL, ROR,
+        INX, INY, DEX, DEY, TAX, TAY, TXA, TYA, TSX, TXS, CLC, SEC, CLV, CLD, SED, NOP,
+        PHA, PHP, PLA, PLP,
+        BPL, BMI, BVC, BVS, BCC, BCS, BNE, BEQ, JMP, JSR, RTS,
+    };
+
+    // Only instructions with the same behavior on both the 6502 and 65C02
+    static bool decode(uint8_t inst, Operation& op, Mode& mode)
+    {
+        switch(inst) {
+            case 0xA9: op = LDA; mode = IMM; return true;
+            case 0xA5: op = LDA; mode = ZPG; return true;
+            case 0xB5: op = LDA; mode = ZPX; return true;
+            case 0xAD: op = LDA; mode = ABS; return true;
+            case 0xBD: op = LDA; mode = ABX; return true;
+            case 0xB9: op = LDA; mode = ABY; return true;
+            case 0xB1: op = LDA; mode = IZY; return true;
+            case 0xA1: op = LDA; mode = IZX; return true;
+            case 0xA2: op = LDX; mode = IMM; return true;
+            case 0xA6: op = LDX; mode = ZPG; return true;
+            case 0xB6: op = LDX; mode = ZPY; return true;
+            case 0xAE: op = LDX; mode = ABS; return true;
+            case 0xBE: op = LDX; mode = ABY; return true;
+            case 0xA0: op = LDY; mode = IMM; return true;
+            case 0xA4: op = LDY; mode = ZPG; return true;
+            case 0xB4: op = LDY; mode = ZPX; return true;
+            case 0xAC: op = LDY; mode = ABS; return true;
+            case 0xBC: op = LDY; mode = ABX; return true;
+            case 0x85: op = STA; mode = ZPG; return true;
+            case 0x95: op = STA; mode = ZPX; return true;
+            case 0x8D: op = STA; mode = ABS; return true;
+            case 0x9D: op = STA; mode = ABX; return true;
+            case 0x99: op = STA; mode = ABY; return true;
+            case 0x91: op = STA; mode = IZY; return true;
+            case 0x81: op = STA; mode = IZX; return true;
+            case 0x86: op = STX; mode = ZPG; return true;
+            case 0x96: op = STX; mode = ZPY; return true;
+            case 0x8E: op = STX; mode = ABS; return true;
+            case 0x84: op = STY; mode = ZPG; return true;
+            case 0x94: op = STY; mode = ZPX; return true;
+            case 0x8C: op = STY; mode = ABS; return true;
+            case 0xE0: op = CPX; mode = IMM; return true;
+            case 0xE4: op = CPX; mode = ZPG; return true;
+            case 0xEC: op = CPX; mode = ABS; return true;
+            case 0xC0: op = CPY; mode = IMM; return true;
+            case 0xC4: op = CPY; mode = ZPG; return true;
+            case 0xCC: op = CPY; mode = ABS; return true;
+            case 0x24: op = BIT; mode = ZPG; return true;
+            case 0x2C: op = BIT; mode = ABS; return true;
+            case 0xE6: op = INC; mode = ZPG; return true;
+            case 0xF6: op = INC; mode = ZPX; return true;
+            case 0xEE: op = INC; mode = ABS; return true;
+            case 0xFE: op = INC; mode = ABX; return true;
+            case 0xC6: op = DEC; mode = ZPG; return true;
+            case 0xD6: op = DEC; mode = ZPX; return true;
+            case 0xCE: op = DEC; mode = ABS; return true;
+            case 0xDE: op = DEC; mode = ABX; return true;
+            case 0x0A: op = ASL; mode = ACC; return true;
+            case 0x06: op = ASL; mode = ZPG; return true;
+            case 0x16: op = ASL; mode = ZPX; return true;
+            case 0x0E: op = ASL; mode = ABS; return true;
+            case 0x4A: op = LSR; mode = ACC; return true;
+            case 0x46: op = LSR; mode = ZPG; return true;
+            case 0x56: op = LSR; mode = ZPX; return true;
+            case 0x4E: op = LSR; mode = ABS; return true;
+            case 0x2A: op = ROL; mode = ACC; return true;
+            case 0x26: op = ROL; mode = ZPG; return true;
+            case 0x36: op = ROL; mode = ZPX; return true;
+            case 0x2E: op = ROL; mode = ABS; return true;
+            case 0x6A: op = ROR; mode = ACC; return true;
+            case 0x66: op = ROR; mode = ZPG; return true;
+            case 0x76: op = ROR; mode = ZPX; return true;
+            case 0x6E: op = ROR; mode = ABS; return true;
+            case 0xE8: op = INX; mode = IMP; return true;
+            case 0xC8: op = INY; mode = IMP; return true;
+            case 0xCA: op = DEX; mode = IMP; return true;
+            case 0x88: op = DEY; mode = IMP; return true;
+            case 0xAA: op = TAX; mode = IMP; return true;
+            case 0xA8: op = TAY; mode = IMP; return true;
+            case 0x8A: op = TXA; mode = IMP; return true;
+            case 0x98: op = TYA; mode = IMP; return true;
+            case 0xBA: op = TSX; mode = IMP; return true;
+            case 0x9A: op = TXS; mode = IMP; return true;
+            case 0x18: op = CLC; mode = IMP; return true;
+            case 0x38: op = SEC; mode = IMP; return true;
+            case 0xB8: op = CLV; mode = IMP; return true;
+            case 0xD8: op = CLD; mode = IMP; return true;
+            case 0xF8: op = SED; mode = IMP; return true;
+            case 0xEA: op = NOP; mode = IMP; return true;
+            case 0x48: op = PHA; mode = IMP; return true;
+            case 0x08: op = PHP; mode = IMP; return true;
+            case 0x68: op = PLA; mode = IMP; return true;
+            case 0x28: op = PLP; mode = IMP; return true;
+            case 0x10: op = BPL; mode = REL; return true;
+            case 0x30: op = BMI; mode = REL; return true;
+            case 0x50: op = BVC; mode = REL; return true;
+            case 0x70: op = BVS; mode = REL; return true;
+            case 0x90: op = BCC; mode = REL; return true;
+            case 0xB0: op = BCS; mode = REL; return true;
+            case 0xD0: op = BNE; mode = REL; return true;
+            case 0xF0: op = BEQ; mode = REL; return true;
+            case 0x4C: op = JMP; mode = ABS; return true;
+            case 0x20: op = JSR; mode = ABS; return true;
+            case 0x60: op = RTS; mode = IMP; return true;
+        }
+
+        static const Operation group1[8] = {ORA, AND, EOR, ADC, STA, LDA, CMP, SBC};
+        static const Mode group1_modes[8] = {IZX, ZPG, IMM, ABS, IZY, ZPX, ABY, ABX};
+        if(((inst & 0x03) == 0x01) && (inst != 0x89)) {
+            op = group1[inst >> 5];
+            mode = group1_modes[(inst >> 2) & 0x07];
+            return (op != STA) && (op != LDA); // those were handled above
+        }
+        return false;
+    }
+
+    static int operand_length(Mode mode)
+    {
+        switch(mode) {
+            case IMP: case ACC: return 0;
+            case ABS: case ABX: case ABY: return 2;
+            default: return 1;
+        }
+    }
+
+    // Translate the instruction at inst_pc, or return false without
+    // emitting anything if it can't be.  Sets done if it ends the block.
+    bool translate_instruction(block_builder& b, uint16_t inst_pc, bool& done)
+    {
+        const uint8_t *code = b.table[inst_pc / 256];
+        Operation op;
+        Mode mode;
+        if(!decode(code[inst_pc % 256], op, mode)) {
+            return false;
+        }
+        int length = 1 + operand_length(mode);
+        if((inst_pc % 256) + length > 256) {
+            return false;
+        }
+        uint16_t operand = (length > 1) ? code[inst_pc % 256 + 1] : 0;
+        if(length > 2) {
+            operand |= code[inst_pc % 256 + 2] << 8;
+        }
+        uint16_t next_pc = inst_pc + length;
+
+        bool is_store = (op == STA) || (op == STX) || (op == STY);
+        bool is_rmw = (mode != ACC) && ((op == INC) || (op == DEC) || (op == ASL) || (op == LSR) || (op == ROL) || (op == ROR));
+        bool is_read = (mode != IMP) && (mode != ACC) && (mode != IMM) && (mode != REL) && !is_store && (op != JMP) && (op != JSR);
+        bool uses_stack = (op == PHA) || (op == PHP) || (op == PLA) || (op == PLP) || (op == JSR) || (op == RTS);
+
+        if(((mode == ZPG) || (mode == ABS)) && (is_read || is_rmw) && !readable(b.table, operand)) {
+            return false;
+        }
+        if(((mode == ZPG) || (mode == ABS)) && (is_store || is_rmw) && io_page(operand / 256)) {
+            return false;
+        }
+        if(((mode == IZY) || (mode == IZX)) && !b.table[0x00]) {
+            return false;
+        }
+        if(uses_stack && !b.table[0x01]) {
+            return false;
+        }
+
+        int c0 = b.cycles; // cycles before this instruction, for bailing
+
+        if((op == ADC) || (op == SBC)) {
+            b.e.op_rr({0xF7}, 0, REG_P);
+            b.e.dword(interpreter::D);
+            emit_bail(b, CC_NE, inst_pc, c0);
+        }
+
+        // Effective address in ESI, with EDI the unindexed base for
+        // modes that can cross a page
+        int cycles = 1 + operand_length(mode);
+        switch(mode) {
+            case ZPG:
+            case ABS:
+                b.e.mov_imm(RSI, operand);
+                break;
+            case ZPX:
+            case ZPY:
+                b.e.mov(RSI, (mode == ZPX) ? REG_X : REG_Y);
+                b.e.op_ri(0, RSI, operand);
+                b.e.op_ri(4, RSI, 0xFF);
+                cycles += 1;
+                break;
+            case ABX:
+            case ABY:
+                b.e.mov(RSI, (mode == ABX) ? REG_X : REG_Y);
+                b.e.op_ri(0, RSI, operand);
+                b.e.op_ri(4, RSI, 0xFFFF);
+                b.e.mov_imm(RDI, operand);
+                if(is_store || is_rmw) {
+                    cycles += 1;
+                }
+                break;
+            case IZY:
+                emit_page_base(b, 0x00, inst_pc, c0);
+                b.e.op_rm({0x0F, 0xB6}, RDI, RDX, -1, 0, operand);
+                b.e.op_rm({0x0F, 0xB6}, RCX, RDX, -1, 0, (operand + 1) & 0xFF);
+                b.e.shift(4, RCX, 8);
+                b.e.op_rr({0x09}, RCX, RDI);
+                b.e.mov(RSI, RDI);
+                b.e.op_rr({0x01}, REG_Y, RSI);
+                b.e.op_ri(4, RSI, 0xFFFF);
+                cycles += 2;
+                if(is_store) {
+                    cycles += 1;
+                }
+                break;
+            case IZX:
+                emit_page_base(b, 0x00, inst_pc, c0);
+                b.e.mov(RCX, REG_X);
+                b.e.op_ri(0, RCX, operand);
+                b.e.op_ri(4, RCX, 0xFF);
+                b.e.op_rm({0x0F, 0xB6}, RSI, RDX, RCX, 0, 0);
+                b.e.op_ri(0, RCX, 1);
+                b.e.op_ri(4, RCX, 0xFF);
+                b.e.op_rm({0x0F, 0xB6}, RCX, RDX, RCX, 0, 0);
+                b.e.shift(4, RCX, 8);
+                b.e.op_rr({0x09}, RCX, RSI);
+                cycles += 3;
+                break;
+            default:
+                break;
+        }
+
+        // Operand value in EAX
+        if(mode == IMM) {
+            b.e.mov_imm(RAX, operand);
+        } else if(is_read || is_rmw) {
+            if((mode == ZPG) || (mode == ABS)) {
+                emit_read_static(b, operand, inst_pc, c0);
+            } else {
+                emit_read_dynamic(b, inst_pc, c0);
+                if(!is_rmw && ((mode == ABX) || (mode == ABY) || (mode == IZY))) {
+                    emit_page_cross_cycle(b);
+                }
+            }
+            cycles += 1;
+        } else if(mode == ACC) {
+            b.e.mov(RAX, REG_A);
+        }
+        if(is_rmw || (mode == ACC) || (mode == IMP)) {
+            cycles += 1;
+        }
+        b.cycles += cycles;
+
+        switch(op) {
+            case LDA: b.e.mov(REG_A, RAX); emit_set_nz(b, REG_A); break;
+            case LDX: b.e.mov(REG_X, RAX); emit_set_nz(b, REG_X); break;
+            case LDY: b.e.mov(REG_Y, RAX); emit_set_nz(b, REG_Y); break;
+
+            case STA: b.e.mov(RDX, REG_A); emit_write(b, next_pc); break;
+            case STX: b.e.mov(RDX, REG_X); emit_write(b, next_pc); break;
+            case STY: b.e.mov(RDX, REG_Y); emit_write(b, next_pc); break;
+
+            case ORA: b.e.op_rr({0x09}, RAX, REG_A); emit_set_nz(b, REG_A); break;
+            case AND: b.e.op_rr({0x21}, RAX, REG_A); emit_set_nz(b, REG_A); break;
+            case EOR: b.e.op_rr({0x31}, RAX, REG_A); emit_set_nz(b, REG_A); break;
+
+            case SBC:
+            case ADC: {
+                // SBC is ADC of the complement, including C and V
+                if(op == SBC) {
+                    b.e.op_ri(6, RAX, 0xFF);
+                }
+                b.e.mov(RCX, REG_P);
+                b.e.op_ri(4, RCX, interpreter::C);
+                b.e.op_rr({0x01}, RAX, RCX);
+                b.e.op_rr({0x01}, REG_A, RCX);
+                b.e.mov(RDX, REG_A);
+                b.e.op_rr({0x31}, RCX, RDX);
+                b.e.mov(RSI, RAX);
+                b.e.op_rr({0x31}, RCX, RSI);
+                b.e.op_rr({0x21}, RSI, RDX);
+                b.e.op_ri(4, RDX, 0x80);
+                b.e.shift(5, RDX, 1);
+                b.e.op_ri(4, REG_P, 0xFF & ~(interpreter::N | interpreter::V | interpreter::Z | interpreter::C));
+                b.e.op_rr({0x09}, RDX, REG_P);
+                b.e.mov(RDX, RCX);
+                b.e.shift(5, RDX, 8);
+                b.e.op_rr({0x09}, RDX, REG_P);
+                b.e.op_ri(4, RCX, 0xFF);
+                b.e.mov(REG_A, RCX);
+                b.e.op_rm({0x0A}, REG_P, RBX, REG_A, 0, offset_of(nz_flags), false, true);
+                break;
+            }
+
+            case CMP:
+            case CPX:
+            case CPY: {
+                int reg = (op == CMP) ? REG_A : (op == CPX) ? REG_X : REG_Y;
+                b.e.op_ri(4, REG_P, 0xFF & ~(interpreter::N | interpreter::Z | interpreter::C));
+                b.e.op_rr({0x39}, RAX, reg);
+                b.e.op_rr({0x0F, 0x90 | CC_AE}, 0, RCX, false, true);
+                b.e.op_rr({0x0F, 0xB6}, RCX, RCX, false, true);
+                b.e.op_rr({0x09}, RCX, REG_P);
+                b.e.mov(RCX, reg);
+                b.e.op_rr({0x29}, RAX, RCX);
+                b.e.op_ri(4, RCX, 0xFF);
+                b.e.op_rm({0x0A}, REG_P, RBX, RCX, 0, offset_of(nz_flags), false, true);
+                break;
+            }
+
+            case BIT:
+                b.e.op_ri(4, REG_P, 0xFF & ~(interpreter::N | interpreter::V | interpreter::Z));
+                b.e.mov(RCX, RAX);
+                b.e.op_ri(4, RCX, interpreter::N | interpreter::V);
+                b.e.op_rr({0x09}, RCX, REG_P);
+                b.e.op_rr({0x85}, REG_A, RAX);
+                b.e.op_rr({0x0F, 0x90 | CC_E}, 0, RCX, false, true);
+                b.e.op_rr({0x0F, 0xB6}, RCX, RCX, false, true);
+                b.e.op_rr({0x01}, RCX, RCX);
+                b.e.op_rr({0x09}, RCX, REG_P);
+                break;
+
+            case INC:
+            case DEC:
+            case ASL:
+            case LSR:
+            case ROL:
+            case ROR: {
+                if((op == INC) || (op == DEC)) {
+                    b.e.op_ri((op == INC) ? 0 : 5, RAX, 1);
+                    b.e.op_ri(4, RAX, 0xFF);
+                    emit_set_nz(b, RAX);
+                } else {
+                    // New carry in EDX, old carry shifted into place in ECX
+                    b.e.mov(RCX, REG_P);
+                    b.e.op_ri(4, RCX, interpreter::C);
+                    b.e.mov(RDX, RAX);
+                    if((op == ASL) || (op == ROL)) {
+                        b.e.shift(5, RDX, 7);
+                        b.e.shift(4, RAX, 1);
+                    } else {
+                        b.e.op_ri(4, RDX, 1);
+                        b.e.shift(5, RAX, 1);
+                        b.e.shift(4, RCX, 7);
+                    }
+                    if((op == ROL) || (op == ROR)) {
+                        b.e.op_rr({0x09}, RCX, RAX);
+                    }
+                    b.e.op_ri(4, RAX, 0xFF);
+                    b.e.op_ri(4, REG_P, 0xFF & ~interpreter::C);
+                    b.e.op_rr({0x09}, RDX, REG_P);
+                    emit_set_nz(b, RAX);
+                }
+                if(mode == ACC) {
+                    b.e.mov(REG_A, RAX);
+                } else {
+                    b.e.mov(RDX, RAX);
+                    emit_write(b, next_pc);
+                }
+                break;
+            }
+
+            case INX: case INY: case DEX: case DEY: {
+                int reg = ((op == INX) || (op == DEX)) ? REG_X : REG_Y;
+                b.e.op_ri(((op == INX) || (op == INY)) ? 0 : 5, reg, 1);
+                b.e.op_ri(4, reg, 0xFF);
+                emit_set_nz(b, reg);
+                break;
+            }
+
+            case TAX: b.e.mov(REG_X, REG_A); emit_set_nz(b, REG_X); break;
+            case TAY: b.e.mov(REG_Y, REG_A); emit_set_nz(b, REG_Y); break;
+            case TXA: b.e.mov(REG_A, REG_X); emit_set_nz(b, REG_A); break;
+            case TYA: b.e.mov(REG_A, REG_Y); emit_set_nz(b, REG_A); break;
+            case TSX:
+                b.e.op_rm({0x0F, 0xB6}, REG_X, RBX, -1, 0, offset_of(&s));
+                emit_set_nz(b, REG_X);
+                break;
+            case TXS:
+                b.e.op_rm({0x88}, REG_X, RBX, -1, 0, offset_of(&s), false, true);
+                break;
+
+            case CLC: b.e.op_ri(4, REG_P, 0xFF & ~interpreter::C); break;
+            case SEC: b.e.op_ri(1, REG_P, interpreter::C); break;
+            case CLV: b.e.op_ri(4, REG_P, 0xFF & ~interpreter::V); break;
+            case CLD: b.e.op_ri(4, REG_P, 0xFF & ~interpreter::D); break;
+            case SED: b.e.op_ri(1, REG_P, interpreter::D); break;
+            case NOP: break;
+
+            case PHA:
+                b.e.mov(RDX, REG_A);
+                emit_push(b, next_pc);
+                break;
+            case PHP:
+                b.e.mov(RDX, REG_P);
+                b.e.op_ri(1, RDX, interpreter::B2 | interpreter::B);
+                emit_push(b, next_pc);
+                break;
+            case PLA:
+                b.cycles += 2; // pipelined pre-increment, pull
+                emit_pull(b, inst_pc, c0);
+                b.e.mov(REG_A, RAX);
+                emit_set_nz(b, REG_A);
+                break;
+            case PLP:
+                b.cycles += 2; // pipelined pre-increment, pull
+                emit_pull(b, inst_pc, c0);
+                b.e.mov(REG_P, RAX);
+                b.e.op_ri(1, REG_P, interpreter::B2 | interpreter::B);
+                // Clearing I may let a waiting IRQ in before the next instruction
+                emit_exit(b, next_pc, b.cycles);
+                done = true;
+                break;
+
+            case BPL: case BMI: case BVC: case BVS:
+            case BCC: case BCS: case BNE: case BEQ: {
+                static const uint8_t flags[4] = {interpreter::N, interpreter::V, interpreter::C, interpreter::Z};
+                uint8_t flag = flags[(code[inst_pc % 256] >> 6) & 0x03];
+                bool if_set = code[inst_pc % 256] & 0x20;
+                int32_t rel = (operand + 128) % 256 - 128;
+                int32_t to = next_pc + rel;
+                int taken_cycles = 1 + (((to / 256) != (next_pc / 256)) ? 1 : 0);
+
+                b.e.op_rr({0xF7}, 0, REG_P);
+                b.e.dword(flag);
+                size_t taken = b.e.jcc(if_set ? CC_NE : CC_E);
+                emit_exit(b, next_pc, b.cycles);
+                b.e.patch(taken, b.e.used);
+                if(static_cast<uint16_t>(to) == b.start) {
+                    // Loop back into this block a limited number of times,
+                    // and only while another pass can't reach the next event
+                    emit_add_cycles(b, b.cycles + taken_cycles);
+                    b.e.op_rm({0x8B}, RAX, RBX, -1, 0, offset_of(&block_cycles));
+                    b.e.op_rm({0x03}, RAX, RBX, -1, 0, offset_of(&pending_cycles));
+                    b.e.op_ri(0, RAX, max_block_cycles);
+                    b.e.op_rm({0x3B}, RAX, RBX, -1, 0, offset_of(&cycle_budget));
+                    size_t event_near = b.e.jcc(CC_AE);
+                    b.e.op_rm({0x81}, 5, RBX, -1, 0, offset_of(&loop_budget));
+                    b.e.dword(1);
+                    b.e.patch(b.e.jcc(CC_NE), b.body);
+                    b.e.patch(event_near, b.e.used);
+                    emit_exit(b, to, 0);
+                } else {
+                    emit_exit(b, to, b.cycles + taken_cycles);
+                }
+                done = true;
+                break;
+            }
+
+            case JMP:
+                emit_exit(b, operand, b.cycles);
+                done = true;
+                break;
+
+            case JSR:
+                b.e.mov_imm(RDX, (inst_pc + 2) >> 8);
+                emit_push(b, next_pc, false);
+                b.e.mov_imm(RDX, (inst_pc + 2) & 0xFF);
+                emit_push(b, next_pc, false);
+                emit_exit(b, operand, 1);
+                done = true;
+                break;
+
+            case RTS:
+                b.cycles += 4; // pipelined pre-increment, two pulls, increment
+                emit_page_base(b, 0x01, inst_pc, c0);
+                b.e.op_rm({0x0F, 0xB6}, RCX, RBX, -1, 0, offset_of(&s));
+                b.e.op_ri(0, RCX, 1);
+                b.e.op_ri(4, RCX, 0xFF);
+                b.e.op_rm({0x0F, 0xB6}, RAX, RDX, RCX, 0, 0);
+                b.e.op_ri(0, RCX, 1);
+                b.e.op_ri(4, RCX, 0xFF);
+                b.e.op_rm({0x0F, 0xB6}, RSI, RDX, RCX, 0, 0);
+                b.e.op_rm({0x88}, RCX, RBX, -1, 0, offset_of(&s), false, true);
+                b.e.shift(4, RSI, 8);
+                b.e.op_rr({0x09}, RSI, RAX);
+                b.e.op_ri(0, RAX, 1);
+                b.e.byte(0x66);
+                b.e.op_rm({0x89}, RAX, RBX, -1, 0, offset_of(&pc));
+                emit_add_cycles(b, b.cycles);
+                b.epilogue_jumps.push_back(b.e.jmp());
+                done = true;
+                break;
+        }
+        return true;
+    }
+
+    block_function translate(uint16_t start)
+    {
+        uint8_t **table = read_page_table(bus, 0);
+        if(!table || !table[start / 256]) {
+            return nullptr;
+        }
+        if(code_used + max_block_size > code_buffer_size) {
+            flush_translations();
+        }
+        read_table = table;
+
+        // Blocks on the same pages as this one can't run while it's written
+        if(!protect_code(code_used, PROT_READ | PROT_WRITE)) {
+            return nullptr;
+        }
+
+        block_builder b;
+        b.e.code = code_buffer + code_used;
+        b.table = table;
+        b.start = start;
+        b.cycles = 0;
+
+        static const int saved[6] = {RBX, RBP, R12, R13, R14, R15};
+        for(int r : saved) {
+            b.e.push(r);
+        }
+        b.e.byte(0x48); b.e.byte(0x83); b.e.byte(0xEC); b.e.byte(0x08); // sub rsp, 8
+        b.e.op_rr({0x89}, RDI, RBX, true);
+        b.e.op_rm({0x8B}, RBP, RBX, -1, 0, offset_of(&read_table), true);
+        b.e.op_rm({0x0F, 0xB6}, REG_A, RBX, -1, 0, offset_of(&a));
+        b.e.op_rm({0x0F, 0xB6}, REG_X, RBX, -1, 0, offset_of(&x));
+        b.e.op_rm({0x0F, 0xB6}, REG_Y, RBX, -1, 0, offset_of(&y));
+        b.e.op_rm({0x0F, 0xB6}, REG_P, RBX, -1, 0, offset_of(&p));
+        b.body = b.e.used;
+
+        uint16_t address = start;
+        int count = 0;
+        bool done = false;
+        while(!done && (count < max_block_instructions) && (address / 256 == start / 256)) {
+            uint16_t inst_pc = address;
+            if(!translate_instruction(b, inst_pc, done)) {
+                break;
+            }
+            Operation op;
+            Mode mode;
+            decode(table[inst_pc / 256][inst_pc % 256], op, mode);
+            address = inst_pc + 1 + operand_length(mode);
+            count++;
+        }
+        if(count == 0) {
+            protect_code(code_used, PROT_READ | PROT_EXEC);
+            return nullptr;
+        }
+        if(!done) {
+            emit_exit(b, address, b.cycles);
+        }
+
+        for(auto& stub : b.stubs) {
+            b.e.patch(stub.jump, b.e.used);
+            emit_exit(b, stub.pc, stub.cycles, stub.bail);
+        }
+
+        size_t epilogue = b.e.used;
+        for(auto jump : b.epilogue_jumps) {
+            b.e.patch(jump, epilogue);
+        }
+        b.e.op_rm({0x88}, REG_A, RBX, -1, 0, offset_of(&a), false, true);
+        b.e.op_rm({0x88}, REG_X, RBX, -1, 0, offset_of(&x), false, true);
+        b.e.op_rm({0x88}, REG_Y, RBX, -1, 0, offset_of(&y), false, true);
+        b.e.op_rm({0x88}, REG_P, RBX, -1, 0, offset_of(&p), false, true);
+        b.e.byte(0x48); b.e.byte(0x83); b.e.byte(0xC4); b.e.byte(0x08); // add rsp, 8
+        for(int i = 5; i >= 0; i--) {
+            b.e.pop(saved[i]);
+        }
+        b.e.byte(0xC3);
+
+        assert(b.e.used <= max_block_size);
+        if(!protect_code(code_used, PROT_READ | PROT_EXEC)) {
+            // Blocks already on these pages can't run either
+            flush_translations();
+            return nullptr;
+        }
+        block_function block = reinterpret_cast<block_function>(code_buffer + code_used);
+        code_used += b.e.used;
+        return block;
+    }
+
+#endif /* CPU6502_JIT_SUPPORTED */
+};
+
+#endif /* CPU6502_JIT_H */
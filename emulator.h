@@ -2,14 +2,27 @@
 #define _SIMULATOR_H_
 
 #include <vector>
+#include <cstdint>
+#include <cstddef>
 #undef max
 
 struct board_base
 {
+    virtual ~board_base() {}
     virtual bool write(int addr, unsigned char data) { return false; }
     virtual bool read(int addr, unsigned char &data) { return false; }
     virtual bool board_get_interrupt(int& irq) { return false; }
 
+    // Address ranges a card answers for the slot it's installed in; the
+    // main board forwards only accesses in those ranges to the card.
+    virtual bool owns_slot_io() { return true; } // $C0n0-$C0nF
+    virtual bool owns_slot_rom() { return true; } // $Cn00-$CnFF
+    virtual bool owns_expansion_rom() { return false; } // $C800-$CFFF while selected
+
+    // Add count samples at 44.1KHz, starting with sample number
+    // first_sample since the machine started, to samples
+    virtual void mix_audio(uint64_t first_sample, float *samples, size_t count) {}
+
     virtual void reset(void) {}
     virtual void idle(void) {};
     virtual void pause(void) {};
@@ -805,6 +805,113 @@ bool GifWriteFrame( GifWriter* writer, const uint8_t* image, uint32_t width, uin
     return true;
 }
 
+// A palette known ahead of time, for images that only ever use its colors.
+// Pixels are mapped to entries by direct lookup on their 5:5:5 RGB instead of
+// through the k-d tree.
+struct GifFixedPalette
+{
+    GifPalette pal;
+    uint8_t lookup[1 << 15]; // palette index by 5:5:5 RGB, 0 if none
+};
+
+int GifFixedPaletteKey(int r, int g, int b) { return ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3); }
+
+// Builds a fixed palette from count (at most 255) RGB triples.  Entry 0 stays
+// the transparent color, and the bit depth is the smallest that holds the rest
+// (but at least 2, the smallest LZW code size).
+void GifMakeFixedPalette( const uint8_t* rgb, int count, GifFixedPalette* pFixed )
+{
+    memset(pFixed, 0, sizeof(*pFixed));
+
+    pFixed->pal.bitDepth = 2;
+    while( (1 << pFixed->pal.bitDepth) < count + 1 )
+        ++pFixed->pal.bitDepth;
+
+    for( int ii=0; ii<count; ++ii )
+    {
+        pFixed->pal.r[ii+1] = rgb[ii*3+0];
+        pFixed->pal.g[ii+1] = rgb[ii*3+1];
+        pFixed->pal.b[ii+1] = rgb[ii*3+2];
+        pFixed->lookup[GifFixedPaletteKey(rgb[ii*3+0], rgb[ii*3+1], rgb[ii*3+2])] = (uint8_t)(ii+1);
+    }
+}
+
+// Writes out a new frame whose pixels all come from a fixed palette, made by
+// GifMakeFixedPalette.  Only the rectangle around the pixels that changed since
+// the last frame is written, with unchanged pixels in it left transparent.
+// If a pixel isn't exactly a palette color, the frame is written with
+// GifWriteFrame() instead, so mixing the two on one GifWriter is fine.
+bool GifWriteFrameFixedPalette( GifWriter* writer, const uint8_t* image, uint32_t width, uint32_t height, uint32_t delay, GifFixedPalette* pFixed )
+{
+    if(!writer->f) return false;
+
+    const uint8_t* oldImage = writer->firstFrame? NULL : writer->oldImage;
+
+    // map every pixel and find the bounds of the ones that changed
+    uint8_t* indices = (uint8_t*)GIF_TEMP_MALLOC(width*height);
+    uint32_t left = width, right = 0, top = height, bottom = 0;
+    for( uint32_t yy=0; yy<height; ++yy )
+    {
+        for( uint32_t xx=0; xx<width; ++xx )
+        {
+            const uint8_t* pixel = image + (yy*width+xx)*4;
+            const uint8_t* last = oldImage ? oldImage + (yy*width+xx)*4 : NULL;
+            if(last && last[0] == pixel[0] && last[1] == pixel[1] && last[2] == pixel[2])
+            {
+                indices[yy*width+xx] = kGifTransIndex;
+                continue;
+            }
+
+            uint8_t ind = pFixed->lookup[GifFixedPaletteKey(pixel[0], pixel[1], pixel[2])];
+            if(ind == 0 || pFixed->pal.r[ind] != pixel[0] || pFixed->pal.g[ind] != pixel[1] || pFixed->pal.b[ind] != pixel[2])
+            {
+                GIF_TEMP_FREE(indices);
+                return GifWriteFrame(writer, image, width, height, delay, 8, false);
+            }
+            indices[yy*width+xx] = ind;
+
+            left = GifIMin((int)left, (int)xx);
+            right = GifIMax((int)right, (int)xx);
+            top = GifIMin((int)top, (int)yy);
+            bottom = GifIMax((int)bottom, (int)yy);
+        }
+    }
+    writer->firstFrame = false;
+
+    if(left > right)
+    {
+        // nothing changed; a single transparent pixel holds the delay
+        left = right = top = bottom = 0;
+    }
+
+    // GifWriteLzwImage() takes the index from the 4th byte of each pixel
+    uint32_t rectWidth = right - left + 1;
+    uint32_t rectHeight = bottom - top + 1;
+    uint8_t* rect = (uint8_t*)GIF_TEMP_MALLOC(rectWidth*rectHeight*4);
+    for( uint32_t yy=0; yy<rectHeight; ++yy )
+    {
+        for( uint32_t xx=0; xx<rectWidth; ++xx )
+        {
+            uint32_t ii = (top+yy)*width + left+xx;
+            uint8_t ind = indices[ii];
+            rect[(yy*rectWidth+xx)*4+3] = ind;
+            if(ind != kGifTransIndex)
+            {
+                writer->oldImage[ii*4+0] = pFixed->pal.r[ind];
+                writer->oldImage[ii*4+1] = pFixed->pal.g[ind];
+                writer->oldImage[ii*4+2] = pFixed->pal.b[ind];
+            }
+        }
+    }
+
+    GifWriteLzwImage(writer->f, rect, left, top, rectWidth, rectHeight, delay, &pFixed->pal);
+
+    GIF_TEMP_FREE(rect);
+    GIF_TEMP_FREE(indices);
+
+    return true;
+}
+
 // Writes the EOF code, closes the file handle, and frees temp memory used by a GIF.
 // Many if not most viewers will still display a GIF properly if the EOF code is missing,
 // but it's still a good idea to write it out.
@@ -12,9 +12,15 @@
 #include <cstring>
 #include <cassert>
 #include <cmath>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <ao/ao.h>
 
 #include "gif.h"
+#include "spsc_ring.h"
+#include "video_render.h"
 
 // implicit centering in widget? Or special centering widget?
 // lines (for around toggle and momentary)
@@ -96,24 +102,6 @@ event dequeue_event()
 }
 
 GLuint artifact_colors_texture;
-uint8_t artifact_colors[][3] = {
-    {  0,   0,   0}, //  0 "black"       -> 0,0,0,0 -> {0.000000, 0.000000, 0.000000}
-    {208,   0,  50}, //  1 "red"         -> 1,0,0,0 -> {0.815901, 0.000000, 0.197238}
-    { 72,  11, 255}, //  2 "dark blue"   -> 0,1,0,0 -> {0.283288, 0.043435, 1.000000}
-    {255,   3, 255}, //  3 "purple"      -> 1,1,0,0 -> {1.000000, 0.015525, 1.000000}
-    {  0, 134,  77}, //  4 "dark green"  -> 0,0,1,0 -> {0.000000, 0.527909, 0.302762}
-    {127, 127, 127}, //  5 "gray 1"      -> 1,0,1,0 -> {0.500000, 0.500000, 0.500000}
-    {  0, 145, 255}, //  6 "medium blue" -> 0,1,1,0 -> {0.000000, 0.571344, 1.000000}
-    {199, 138, 255}, //  7 "light blue"  -> 1,1,1,0 -> {0.783288, 0.543435, 1.000000}
-    { 55, 116,   0}, //  8 "brown"       -> 0,0,0,1 -> {0.216712, 0.456565, 0.000000}
-    {255, 109,   0}, //  9 "orange"      -> 1,0,0,1 -> {1.000000, 0.428656, 0.000000}
-    {127, 127, 127}, // 10 "gray 2"      -> 0,1,0,1 -> {0.500000, 0.500000, 0.500000}
-    {255, 120, 177}, // 11 "pink"        -> 1,1,0,1 -> {1.000000, 0.472091, 0.697238}
-    {  0, 251,   0}, // 12 "light green" -> 0,0,1,1 -> {0.000000, 0.984475, 0.000000}
-    {182, 243,   0}, // 13 "yello"       -> 1,0,1,1 -> {0.716712, 0.956565, 0.000000}
-    { 46, 255, 204}, // 14 "aqua"        -> 0,1,1,1 -> {0.184099, 1.000000, 0.802762}
-    {255, 255, 255}, // 15 "white"       -> 1,1,1,1 -> {1.000000, 1.000000, 1.000000}
-};
 
 opengl_texture font_texture;
 constexpr uint32_t fonttexture_w = 7;
@@ -1444,41 +1432,174 @@ struct floppy_icon : public widget
     }
 };
 
-// Globals for GIF recording.
-static GifWriter gif_writer;
-static bool gif_recording = false;
+// Recording hands each captured frame to an encoder thread through
+// recorded_frames, so GIF quantization and compression or raw frame
+// writes never hold up the emulator.  Frame buffers come back through
+// free_frames; if the encoder falls behind and none is free, the frame
+// is skipped and the next one captured is shown that much longer.  The
+// encoder sleeps on recording_wakeup while there's nothing to encode.
+constexpr uint32_t recording_width = apple2_screen_width * recording_scale;
+constexpr uint32_t recording_height = apple2_screen_height * recording_scale;
+constexpr size_t recording_frame_buffers = 16;
+
+struct recorded_frame
+{
+    uint8_t rgba[recording_width * recording_height * 4];
+    uint32_t periods; // how many frame periods to show this frame for
+};
+
+spsc_ring<recorded_frame*, recording_frame_buffers> recorded_frames;
+spsc_ring<recorded_frame*, recording_frame_buffers> free_frames;
+static std::atomic<bool> recording_running(false);
+static std::thread *recording_thread;
+static std::mutex recording_mutex;
+static std::condition_variable recording_wakeup;
+static bool video_recording = false;
+static VideoFormat video_format = VIDEO_GIF;
+static uint32_t skipped_periods = 0;
+
+static const char *video_filename(VideoFormat format)
+{
+    switch(format) {
+        case VIDEO_Y4M: return "out.y4m";
+        case VIDEO_PPM: return "out.ppm";
+        default: return "out.gif";
+    }
+}
+
+// Full-range RGB to BT.601 studio-range Y'CbCr
+static void write_y4m_frame(FILE *fp, const uint8_t *rgba)
+{
+    static uint8_t planes[3][recording_width * recording_height];
+    for(uint32_t i = 0; i < recording_width * recording_height; i++) {
+        int r = rgba[i * 4 + 0], g = rgba[i * 4 + 1], b = rgba[i * 4 + 2];
+        planes[0][i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        planes[1][i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+        planes[2][i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+    }
+    fprintf(fp, "FRAME\n");
+    fwrite(planes, sizeof(planes), 1, fp);
+}
+
+static void write_ppm_frame(FILE *fp, const uint8_t *rgba)
+{
+    static uint8_t rgb[recording_width * recording_height * 3];
+    for(uint32_t i = 0; i < recording_width * recording_height; i++) {
+        rgb[i * 3 + 0] = rgba[i * 4 + 0];
+        rgb[i * 3 + 1] = rgba[i * 4 + 1];
+        rgb[i * 3 + 2] = rgba[i * 4 + 2];
+    }
+    fprintf(fp, "P6\n%u %u\n255\n", recording_width, recording_height);
+    fwrite(rgb, sizeof(rgb), 1, fp);
+}
+
+// Called after queueing a frame or clearing recording_running.  Taking
+// the mutex keeps the wakeup from landing between the encoder finding
+// nothing to do and starting to wait.
+static void wake_encoder()
+{
+    {
+        std::lock_guard<std::mutex> lock(recording_mutex);
+    }
+    recording_wakeup.notify_one();
+}
+
+static void encode_recording(VideoFormat format)
+{
+    GifWriter gif_writer;
+    static GifFixedPalette screen_palette; // the screen is only ever drawn in these
+    FILE *fp = nullptr;
+    const char *filename = video_filename(format);
+
+    if(format == VIDEO_GIF) {
+        GifMakeFixedPalette(&artifact_colors[0][0], 16, &screen_palette);
+        if(!GifBegin(&gif_writer, filename, recording_width, recording_height, recording_frame_duration_hundredths)) {
+            fprintf(stderr, "couldn't open %s for recording\n", filename);
+        }
+    } else {
+        fp = fopen(filename, "wb");
+        if(fp == nullptr) {
+            fprintf(stderr, "couldn't open %s for recording\n", filename);
+        } else if(format == VIDEO_Y4M) {
+            fprintf(fp, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", recording_width, recording_height, 100 / recording_frame_duration_hundredths);
+        }
+    }
+
+    while(true) {
+        // Checked before popping so that once recording stops, every frame
+        // pushed before that is seen before giving up
+        bool running = recording_running;
+        recorded_frame *frame;
+        if(recorded_frames.pop(&frame, 1) == 0) {
+            if(!running) {
+                break;
+            }
+            std::unique_lock<std::mutex> lock(recording_mutex);
+            recording_wakeup.wait(lock, []{ return (recorded_frames.size() > 0) || !recording_running; });
+            continue;
+        }
+
+        if(format == VIDEO_GIF) {
+            GifWriteFrameFixedPalette(&gif_writer, frame->rgba, recording_width, recording_height, recording_frame_duration_hundredths * frame->periods, &screen_palette);
+        } else if(fp != nullptr) {
+            for(uint32_t i = 0; i < frame->periods; i++) {
+                if(format == VIDEO_Y4M) {
+                    write_y4m_frame(fp, frame->rgba);
+                } else {
+                    write_ppm_frame(fp, frame->rgba);
+                }
+            }
+        }
+        free_frames.push(&frame, 1);
+    }
+
+    if(format == VIDEO_GIF) {
+        GifEnd(&gif_writer);
+    } else if(fp != nullptr) {
+        fclose(fp);
+    }
+}
 
 /**
- * Stop recording all frames to a GIF file.
+ * Stop recording frames, waiting for the encoder to finish the file.
  */
 static void stop_record()
 {
-    if (gif_recording) {
-        GifEnd(&gif_writer);
-        gif_recording = false;
+    if (video_recording) {
+        recording_running = false;
+        wake_encoder();
+        recording_thread->join();
+        delete recording_thread;
+        recording_thread = nullptr;
+        video_recording = false;
         event_queue.push_back({WITHDRAW_ITERATION_PERIOD_REQUEST, 0});
     }
 }
 
 /**
- * Start recording all frames to a GIF file.
+ * Start recording all frames to out.gif, out.y4m, or out.ppm.
  */
 static void start_record()
 {
-    if (gif_recording) {
+    if (video_recording) {
         stop_record();
     }
 
     if(!rendertarget_for_recording) {
-        rendertarget_for_recording = new render_target(apple2_screen_width * recording_scale, apple2_screen_height * recording_scale);
+        rendertarget_for_recording = new render_target(recording_width, recording_height);
+        for(size_t i = 0; i < recording_frame_buffers; i++) {
+            recorded_frame *frame = new recorded_frame;
+            free_frames.push(&frame, 1);
+        }
     }
 
-    GifBegin(&gif_writer, "out.gif", apple2_screen_width * recording_scale, apple2_screen_height * recording_scale, recording_frame_duration_hundredths);
+    skipped_periods = 0;
+    recording_running = true;
+    recording_thread = new std::thread(encode_recording, video_format);
     event_queue.push_back({REQUEST_ITERATION_PERIOD_IN_MILLIS, recording_frame_duration_hundredths * 10});
-    gif_recording = true;
+    video_recording = true;
 }
 
-
 floppy_icon *floppy0_icon;
 floppy_icon *floppy1_icon;
 
@@ -1500,9 +1621,12 @@ void initialize_widgets(bool run_fast, bool add_floppies, bool floppy0_inserted,
     caps_toggle = new toggle("CAPS", true, [](){force_caps_on = true;}, [](){force_caps_on = false;});
     toggle *color_toggle = new toggle("COLOR", false, [](){draw_using_color = true;}, [](){draw_using_color = false;});
     toggle *pause_toggle = new toggle("PAUSE", false, [](){event_queue.push_back({PAUSE, 1});}, [](){event_queue.push_back({PAUSE, 0});});
+    momentary *save_state_momentary = new momentary("SAVE STATE", [](){event_queue.push_back({SAVE_STATE, 0, strdup("state.a2s")});});
+    momentary *load_state_momentary = new momentary("LOAD STATE", [](){event_queue.push_back({LOAD_STATE, 0, strdup("state.a2s")});});
+    momentary *rewind_momentary = new momentary("REWIND", [](){event_queue.push_back({REWIND, 1000});});
     record_toggle = new toggle("RECORD", false, [](){start_record();}, [](){stop_record();});
 
-    vector<widget*> controls = {hgr_momentary, reset_momentary, reboot_momentary, fast_toggle, caps_toggle, color_toggle, pause_toggle, record_toggle};
+    vector<widget*> controls = {hgr_momentary, reset_momentary, reboot_momentary, fast_toggle, caps_toggle, color_toggle, pause_toggle, save_state_momentary, load_state_momentary, rewind_momentary, record_toggle};
     
     if(true) {
         speed_textbox = new textbox("X.YYY MHz");
@@ -1586,13 +1710,20 @@ void save_rgba_to_ppm(const uint8_t *rgba8_pixels, uint32_t width, uint32_t heig
     fclose(fp);
 }
 
-void add_rendertarget_to_gif(double now, render_target *rt)
+void add_rendertarget_to_recording(double now, render_target *rt)
 {
-    static uint8_t image_recorded[apple2_screen_width * recording_scale * apple2_screen_height * recording_scale * 4];
-    
+    recorded_frame *frame;
+    if(free_frames.pop(&frame, 1) == 0) {
+        // The encoder is behind; stretch the next frame over this one
+        skipped_periods++;
+        return;
+    }
+    frame->periods = 1 + skipped_periods;
+    skipped_periods = 0;
+
     rt->start_rendering();
 
-        glViewport(0, 0, apple2_screen_width * recording_scale, apple2_screen_height * recording_scale);
+        glViewport(0, 0, recording_width, recording_height);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         screen_only->draw(now, recording_transform, 0, 0, apple2_screen_width, apple2_screen_height);
 
@@ -1600,16 +1731,17 @@ void add_rendertarget_to_gif(double now, render_target *rt)
 
     rt->start_reading();
 
-        glReadPixels(0, 0, apple2_screen_width * recording_scale, apple2_screen_height * recording_scale, GL_RGBA, GL_UNSIGNED_BYTE, image_recorded);
+        glReadPixels(0, 0, recording_width, recording_height, GL_RGBA, GL_UNSIGNED_BYTE, frame->rgba);
 
         // Enable to debug framebuffer operations by writing result to screen.ppm.
         if(false) {
-            save_rgba_to_ppm(image_recorded, apple2_screen_width * recording_scale, apple2_screen_height * recording_scale, "screen.ppm");
+            save_rgba_to_ppm(frame->rgba, recording_width, recording_height, "screen.ppm");
         }
 
-        GifWriteFrame(&gif_writer, image_recorded, apple2_screen_width * recording_scale, apple2_screen_height * recording_scale, recording_frame_duration_hundredths, 8, false);
-
     rt->stop_reading();
+
+    recorded_frames.push(&frame, 1);
+    wake_encoder();
 }
 
 static void redraw(GLFWwindow *window)
@@ -1626,8 +1758,8 @@ static void redraw(GLFWwindow *window)
 
     CheckOpenGL(__FILE__, __LINE__);
 
-    if(gif_recording) {
-        add_rendertarget_to_gif(elapsed.count(), rendertarget_for_recording);
+    if(video_recording) {
+        add_rendertarget_to_recording(elapsed.count(), rendertarget_for_recording);
     }
 }
 
@@ -1798,9 +1930,58 @@ void drop_callback(GLFWwindow* window, int count, const char** paths)
     ui->drop(elapsed.count(), wx, wy, count, paths);
 }
 
-void enqueue_audio_samples(uint8_t *buf, size_t sz)
+// Samples go from the emulator's thread through audio_ring to a thread
+// that waits in ao_play(), so the emulator never waits on the device.  The
+// emulated clock and the device's clock drift apart, so the audio thread
+// keeps about audio_target_queued samples in the ring, dropping a sample
+// from a chunk when there are too many and holding the last sample when
+// there are too few.
+constexpr size_t audio_chunk_size = 441; // 10ms
+constexpr size_t audio_target_queued = 44100 * 60 / 1000;
+spsc_ring<int16_t, 16384> audio_ring;
+std::atomic<bool> audio_running(false);
+static std::thread *audio_thread;
+
+void enqueue_audio_samples(int16_t *buf, size_t sz)
+{
+    audio_ring.push(buf, sz); // what doesn't fit is dropped
+}
+
+void play_audio()
 {
-    ao_play(aodev, (char*)buf, sz);
+    int16_t chunk[audio_chunk_size + 1];
+    int16_t last = 0;
+    while(audio_running) {
+        size_t queued = audio_ring.size();
+        if(queued > audio_target_queued * 4) {
+            // Far behind, as after a pause; skip to the target
+            int16_t discard[audio_chunk_size];
+            size_t excess = queued - audio_target_queued;
+            while(excess > 0) {
+                size_t popped = audio_ring.pop(discard, std::min(excess, audio_chunk_size));
+                if(popped == 0) {
+                    break;
+                }
+                excess -= popped;
+            }
+            queued = audio_target_queued;
+        }
+        size_t got;
+        if(queued > audio_target_queued * 2) {
+            got = audio_ring.pop(chunk, audio_chunk_size + 1);
+            if(got == audio_chunk_size + 1) {
+                memmove(chunk + audio_chunk_size / 2, chunk + audio_chunk_size / 2 + 1, (audio_chunk_size / 2) * sizeof(chunk[0]));
+                got = audio_chunk_size;
+            }
+        } else {
+            got = audio_ring.pop(chunk, audio_chunk_size);
+        }
+        if(got > 0) {
+            last = chunk[got - 1];
+        }
+        std::fill(chunk + got, chunk + audio_chunk_size, last);
+        ao_play(aodev, (char*)chunk, audio_chunk_size * sizeof(chunk[0]));
+    }
 }
 
 ao_device *open_ao()
@@ -1814,10 +1995,10 @@ ao_device *open_ao()
     default_driver = ao_default_driver_id();
 
     memset(&format, 0, sizeof(format));
-    format.bits = 8;
+    format.bits = 16;
     format.channels = 1;
     format.rate = 44100;
-    format.byte_format = AO_FMT_LITTLE;
+    format.byte_format = AO_FMT_NATIVE;
 
     /* -- Open driver -- */
     device = ao_open_live(default_driver, &format, NULL /* no options */);
@@ -1835,6 +2016,8 @@ void start(bool run_fast, bool add_floppies, bool floppy0_inserted, bool floppy1
     aodev = open_ao();
     if(aodev == NULL)
         exit(EXIT_FAILURE);
+    audio_running = true;
+    audio_thread = new std::thread(play_audio);
 
     load_joystick_setup();
 
@@ -1878,7 +2061,7 @@ void start(bool run_fast, bool add_floppies, bool floppy0_inserted, bool floppy1
     CheckOpenGL(__FILE__, __LINE__);
 }
 
-void apply_writes(void);
+void apply_writes(unsigned long long current_byte);
 
 // All the "lines" in this function are from the beginning of time, to properly set the mode for
 // scanlines as they are scanned out and persisted.  E.g. frame N, line 191 through frame N+2, line 0
@@ -1950,7 +2133,7 @@ void iterate(const ModeHistory& history, unsigned long long current_byte, float
         speed_textbox->set_content(speed_cstr);
     }
 
-    apply_writes();
+    apply_writes(current_byte);
 
     CheckOpenGL(__FILE__, __LINE__);
     if(glfwWindowShouldClose(my_window)) {
@@ -2033,8 +2216,26 @@ void iterate(const ModeHistory& history, unsigned long long current_byte, float
     glfwPollEvents();
 }
 
+void record_video(VideoFormat format)
+{
+    video_format = format;
+    record_toggle->set_value(true);
+}
+
 void shutdown()
 {
+    stop_record();
+    if(audio_thread) {
+        // play_audio() checks audio_running after each chunk it plays, so
+        // the device is only closed once it's done with it
+        audio_running = false;
+        audio_thread->join();
+        delete audio_thread;
+        audio_thread = nullptr;
+        ao_close(aodev);
+        aodev = nullptr;
+        ao_shutdown();
+    }
     glfwTerminate();
 }
 
@@ -2045,106 +2246,148 @@ constexpr uint16_t hires_page1_base = 0x2000;
 constexpr uint16_t hires_page2_base = 0x4000;
 constexpr uint16_t hires_page_size = 8192;
 
-extern uint16_t text_row_base_offsets[24];
 extern uint16_t hires_memory_to_scanout_address[8192];
+constexpr uint16_t hires_hole = 0xFFFF;
+
+// Display writes are journaled with the CPU clock and only reach the
+// textures once the beam has scanned out the line they are on, so a
+// frame shows memory as it was when each line was drawn.  A write goes
+// into a copy of its texture's texels and marks the row dirty;
+// apply_writes() then uploads each run of dirty rows with one
+// glTexSubImage2D instead of one call per byte.
+uint8_t textport_texels[2][2][textport_h][textport_w]; // [aux][page]
+uint8_t hires_texels[2][2][hires_h][hires_w]; // [aux][page]
+bool textport_dirty[2][2][textport_h];
+bool hires_dirty[2][2][hires_h];
+
+struct display_write
+{
+    uint64_t when;
+    uint16_t addr;
+    uint8_t data;
+    bool aux;
+    uint8_t scanline; // first scanline showing this byte
+};
+vector<display_write> display_writes; // not yet scanned out, in the order they were made
 
-typedef pair<uint16_t, bool> address_auxpage;
-map<address_auxpage, uint8_t> writes;
-int collisions = 0;
-
-void write2(uint16_t addr, bool aux, uint8_t data)
+// Scanline the byte at addr first appears on, or -1 if it's not displayed
+int display_scanline(uint16_t addr)
 {
     // We know text page 1 and 2 are contiguous
     if((addr >= text_page1_base) && (addr < text_page2_base + text_page_size)) {
-        uint16_t page = (addr >= text_page2_base) ? 1 : 0;
-        uint16_t within_page = addr - text_page1_base - page * text_page_size;
-        for(int row = 0; row < 24; row++) {
-            uint16_t row_offset = text_row_base_offsets[row];
-            if((within_page >= row_offset) && (within_page < row_offset + 40)) {
-                uint16_t col = within_page - row_offset;
-                glBindTexture(GL_TEXTURE_2D, textport_texture[aux ? 1 : 0][page]);
-                glTexSubImage2D(GL_TEXTURE_2D, 0, col, row, 1, 1, GL_RED, GL_UNSIGNED_BYTE, &data);
-                CheckOpenGL(__FILE__, __LINE__);
-            }
-        }
+        uint16_t within_page = (addr - text_page1_base) % text_page_size;
+        // Each 128 bytes holds rows N, N + 8, and N + 16 followed by 8 unused bytes
+        uint16_t third = (within_page & 0x7F) / 40;
+        if(third == 3)
+            return -1;
+        return (third * 8 + within_page / 0x80) * 8;
 
     } else if(((addr >= hires_page1_base) && (addr < hires_page1_base + hires_page_size)) || ((addr >= hires_page2_base) && (addr < hires_page2_base + hires_page_size))) {
+        uint16_t scanout_address = hires_memory_to_scanout_address[(addr - hires_page1_base) % hires_page_size];
+        if(scanout_address == hires_hole)
+            return -1;
+        return scanout_address / 40;
+    }
+    return -1;
+}
+
+void store_write(const display_write& w)
+{
+    if(w.addr < hires_page1_base) {
+
+        uint16_t page = (w.addr >= text_page2_base) ? 1 : 0;
+        uint16_t col = ((w.addr - text_page1_base) & 0x7F) % 40;
+        uint16_t row = w.scanline / 8;
+        textport_texels[w.aux][page][row][col] = w.data;
+        textport_dirty[w.aux][page][row] = true;
+
+    } else {
 
-        uint16_t page = (addr < hires_page2_base) ? 0 : 1;
-        uint16_t page_base = (page == 0) ? hires_page1_base : hires_page2_base;
-        uint16_t within_page = addr - page_base;
-        uint16_t scanout_address = hires_memory_to_scanout_address[within_page];
-        uint16_t row = scanout_address / 40;
-        uint16_t col = scanout_address % 40;
-        glBindTexture(GL_TEXTURE_2D, hires_texture[aux][page]);
-        if(page == 0) hgr_page1[addr - 0x2000] = data; // XXX hack
-        uint8_t pixels[8];
+        uint16_t page = (w.addr < hires_page2_base) ? 0 : 1;
+        uint16_t col = hires_memory_to_scanout_address[(w.addr - hires_page1_base) % hires_page_size] % 40;
+        uint8_t *pixels = &hires_texels[w.aux][page][w.scanline][col * 8];
         for(int i = 0; i < 8 ; i++)
-            pixels[i] = ((data & (1 << i)) ? 255 : 0);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, col * 8, row, 8, 1, GL_RED, GL_UNSIGNED_BYTE, pixels);
-        CheckOpenGL(__FILE__, __LINE__);
+            pixels[i] = ((w.data & (1 << i)) ? 255 : 0);
+        hires_dirty[w.aux][page][w.scanline] = true;
     }
 }
 
-void apply_writes(void)
+void upload_dirty_rows(const opengl_texture& texture, const uint8_t *texels, bool *dirty, int w, int h)
 {
-    for(auto it : writes) {
-        uint16_t addr;
-        bool aux;
-        tie(addr, aux) = it.first;
-        write2(addr, aux, it.second); 
-    }
-    writes.clear();
-    collisions = 0;
+    int row = 0;
+    bool bound = false;
+    while(row < h) {
+        if(!dirty[row]) {
+            row++;
+            continue;
+        }
+        int first = row;
+        while((row < h) && dirty[row]) {
+            dirty[row++] = false;
+        }
+        if(!bound) {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            bound = true;
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, w, row - first, GL_RED, GL_UNSIGNED_BYTE, texels + first * w);
+        CheckOpenGL(__FILE__, __LINE__);
+    }
 }
 
-bool write(uint16_t addr, bool aux, uint8_t data)
+// Lines are counted the same way as in map_mode_to_lines(), so memory
+// and mode changes made at the same time reach the same scanline.
+void apply_writes(unsigned long long current_byte)
 {
-    // We know text page 1 and 2 are contiguous
-    if((addr >= text_page1_base) && (addr < text_page2_base + text_page_size)) {
-
-        if(writes.find({addr, aux}) != writes.end())
-            collisions++;
-        writes[{addr, aux}] = data;
-        return true;
+    uint64_t to_line = (current_byte + 17029) / 65;
+    uint64_t previous_when = 0;
+    size_t kept = 0;
+
+    for(size_t i = 0; i < display_writes.size(); i++) {
+        display_write w = display_writes[i];
+
+        if(w.when < previous_when) {
+            // The clock went back, as when loading a saved state, so
+            // whatever is waiting won't be scanned out on this timeline
+            for(size_t j = 0; j < kept; j++) {
+                store_write(display_writes[j]);
+            }
+            kept = 0;
+        }
+        previous_when = w.when;
 
-    } else if(((addr >= hires_page1_base) && (addr < hires_page1_base + hires_page_size)) || ((addr >= hires_page2_base) && (addr < hires_page2_base + hires_page_size))) {
+        uint64_t line = (w.when + 17029) / 65;
+        uint64_t scanned_at = line + (w.scanline + 262 - line % 262) % 262;
+        if(scanned_at < to_line) {
+            store_write(w);
+        } else {
+            display_writes[kept++] = w;
+        }
+    }
+    display_writes.resize(kept);
 
-        if(writes.find({addr, aux}) != writes.end())
-            collisions++;
-        writes[{addr, aux}] = data;
-        return true;
+    for(int aux = 0; aux < 2; aux++) {
+        for(int page = 0; page < 2; page++) {
+            upload_dirty_rows(textport_texture[aux][page], &textport_texels[aux][page][0][0], textport_dirty[aux][page], textport_w, textport_h);
+            upload_dirty_rows(hires_texture[aux][page], &hires_texels[aux][page][0][0], hires_dirty[aux][page], hires_w, hires_h);
+        }
     }
-    return false;
 }
 
-uint16_t text_row_base_offsets[24] =
+bool write(uint16_t addr, bool aux, uint8_t data, uint64_t when)
 {
-    0x000,
-    0x080,
-    0x100,
-    0x180,
-    0x200,
-    0x280,
-    0x300,
-    0x380,
-    0x028,
-    0x0A8,
-    0x128,
-    0x1A8,
-    0x228,
-    0x2A8,
-    0x328,
-    0x3A8,
-    0x050,
-    0x0D0,
-    0x150,
-    0x1D0,
-    0x250,
-    0x2D0,
-    0x350,
-    0x3D0,
-};
+    bool text = (addr >= text_page1_base) && (addr < text_page2_base + text_page_size);
+    bool hires = ((addr >= hires_page1_base) && (addr < hires_page1_base + hires_page_size)) || ((addr >= hires_page2_base) && (addr < hires_page2_base + hires_page_size));
+    if(!text && !hires)
+        return false;
+
+    if(hires && (addr < hires_page2_base)) hgr_page1[addr - 0x2000] = data; // XXX hack
+
+    int scanline = display_scanline(addr);
+    if(scanline >= 0) {
+        display_writes.push_back({when, addr, data, aux, static_cast<uint8_t>(scanline)});
+    }
+    return true;
+}
 
 static uint16_t hires_row_base_offsets[192] =
 {
@@ -2179,6 +2422,10 @@ uint16_t hires_memory_to_scanout_address[8192];
 static void initialize_memory_to_scanout() __attribute__((constructor));
 void initialize_memory_to_scanout()
 {
+    // The 8 bytes after every 120 are not displayed
+    for(uint16_t i = 0; i < 8192; i++) {
+        hires_memory_to_scanout_address[i] = hires_hole;
+    }
     for(uint16_t row = 0; row < 192; row++) {
         uint16_t row_address = hires_row_base_offsets[row];
         for(uint16_t byte = 0; byte < 40; byte++) {
@@ -2187,873 +2434,6 @@ void initialize_memory_to_scanout()
     }
 }
 
-uint16_t font_offset = 32;
-const uint8_t font_bytes[96 * 7 * 8] = {
-    // 32 :  
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 33 : !
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 34 : "
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 35 : #
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 36 : $
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 37 : %
-    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 38 : &
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 39 : '
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 40 : (
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 41 : )
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 42 : *
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 43 : +
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 44 : ,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 45 : -
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 46 : .
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 47 : /
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 48 : 0
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 49 : 1
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 50 : 2
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 51 : 3
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 52 : 4
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 53 : 5
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 54 : 6
-    0x00,0x00,0x00,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 55 : 7
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 56 : 8
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 57 : 9
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 58 : :
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 59 : ;
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 60 : <
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 61 : =
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 62 : >
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 63 : ?
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 64 : @
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 65 : A
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 66 : B
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 67 : C
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 68 : D
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 69 : E
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 70 : F
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 71 : G
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 72 : H
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 73 : I
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 74 : J
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 75 : K
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 76 : L
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 77 : M
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0x00,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 78 : N
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 79 : O
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 80 : P
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 81 : Q
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 82 : R
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 83 : S
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 84 : T
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 85 : U
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 86 : V
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 87 : W
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0x00,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 88 : X
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 89 : Y
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 90 : Z
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 91 : [
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 92 : backslash
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 93 : ]
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 94 : ^
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 95 : _
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-    // 96 : `
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 97 : a
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 98 : b
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 99 : c
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 100 : d
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 101 : e
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 102 : f
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 103 : g
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    // 104 : h
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 105 : i
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 106 : j
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
-    // 107 : k
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 108 : l
-    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 109 : m
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0x00,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 110 : n
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 111 : o
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 112 : p
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    // 113 : q
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    // 114 : r
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 115 : s
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 116 : t
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 117 : u
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 118 : v
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 119 : w
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0xFF,0x00,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 120 : x
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 121 : y
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
-    // 122 : z
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 123 : {
-    0x00,0x00,0x00,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 124 : |
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
-    // 125 : }
-    0x00,0xFF,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0xFF,0xFF,0xFF,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 126 : ~
-    0x00,0x00,0xFF,0xFF,0x00,0xFF,0x00,
-    0x00,0xFF,0x00,0xFF,0xFF,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    // 127 : 
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
-    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-};
 
 
 };
@@ -1,3 +1,6 @@
+#ifndef INTERFACE_H
+#define INTERFACE_H
+
 #include <tuple>
 #include <vector>
 
@@ -7,6 +10,8 @@ namespace APPLE2Einterface
 enum EventType
 {
     NONE, KEYDOWN, KEYUP, RESET, REBOOT, PASTE, SPEED, QUIT, PAUSE, EJECT_FLOPPY, INSERT_FLOPPY,
+    SAVE_STATE, LOAD_STATE,                     /* str is the state filename */
+    REWIND,                                     /* value is how many milliseconds of emulated time to go back */
     REQUEST_ITERATION_PERIOD_IN_MILLIS,         /* request fixed simulation time period between calls to iterate() */
     WITHDRAW_ITERATION_PERIOD_REQUEST,          /* withdraw request for fixed simulation time */
 };
@@ -90,16 +95,26 @@ struct ModeSettings
 typedef std::tuple<uint64_t, ModeSettings> ModePoint;
 typedef std::vector<ModePoint> ModeHistory;
 
-bool write(uint16_t addr, bool aux, uint8_t data);
+// Stamped with the CPU clock, like ModePoint, so the write is shown once
+// the beam reaches the line it's on
+bool write(uint16_t addr, bool aux, uint8_t data, uint64_t when);
 
 std::tuple<float,bool> get_paddle(int num);
 
 void show_floppy_activity(int number, bool activity);
 
-void enqueue_audio_samples(uint8_t *buf, size_t sz);
+void enqueue_audio_samples(int16_t *buf, size_t sz);
 
 void start(bool run_fast, bool add_floppies, bool floppy0_inserted, bool floppy1_inserted);
+
+// Formats the RECORD button can write the screen in, to out.gif, out.y4m
+// (uncompressed 4:4:4 video), or out.ppm (a lossless stream of frames)
+enum VideoFormat {VIDEO_GIF, VIDEO_Y4M, VIDEO_PPM};
+void record_video(VideoFormat format); // start recording, after start()
+
 void iterate(const ModeHistory& history, unsigned long long current_byte_in_frame, float megahertz); // display
 void shutdown();
 
 };
+
+#endif /* INTERFACE_H */
@@ -172,6 +172,11 @@ void start(bool run_fast, bool add_floppies, bool floppy0_inserted, bool floppy1
     start_keyboard();
 }
 
+void record_video(VideoFormat format)
+{
+    fprintf(stderr, "the text interface can't record video\n");
+}
+
 void apply_writes(void);
 
 void poll_keyboard()
@@ -284,7 +289,7 @@ void apply_writes(void)
     collisions = 0;
 }
 
-bool write(uint16_t addr, bool aux, uint8_t data)
+bool write(uint16_t addr, bool aux, uint8_t data, uint64_t when)
 {
     // We know text page 1 and 2 are contiguous
     if((addr >= text_page1_base) && (addr < text_page2_base + text_page_size)) {
@@ -331,7 +336,7 @@ void show_floppy_activity(int number, bool activity)
 {
 }
 
-void enqueue_audio_samples(uint8_t *buf, size_t sz)
+void enqueue_audio_samples(int16_t *buf, size_t sz)
 {
 }
 
@@ -0,0 +1,61 @@
+/*
+    spsc_ring<T, N> is a queue of up to N items (N a power of two) for
+    one thread to push into and one other thread to pop from, without
+    locks and without either side ever waiting on the other.
+
+    Methods:
+        push(items, count) - (producer) append up to count items, returning
+            how many fit
+        pop(items, count) - (consumer) remove up to count items, returning
+            how many there were
+        size() - how many items are queued; exact from either side for
+            what that side has done, a lower bound for the other side
+*/
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <atomic>
+#include <algorithm>
+
+template <class T, size_t N>
+struct spsc_ring
+{
+    static_assert((N & (N - 1)) == 0, "spsc_ring size must be a power of two");
+
+    T items[N];
+    std::atomic<size_t> head{0}; // next item to pop, only written by the consumer
+    std::atomic<size_t> tail{0}; // next item to push, only written by the producer
+
+    size_t size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    size_t push(const T *src, size_t count)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        count = std::min(count, N - (t - h));
+        for(size_t i = 0; i < count; i++) {
+            items[(t + i) % N] = src[i];
+        }
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t pop(T *dst, size_t count)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        count = std::min(count, t - h);
+        for(size_t i = 0; i < count; i++) {
+            dst[i] = items[(h + i) % N];
+        }
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+};
+
+#endif /* SPSC_RING_H */
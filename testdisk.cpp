@@ -0,0 +1,278 @@
+// Checks the Disk II track encoders and decoders on made-up images:
+// nybblized tracks must decode back to the sectors they were made from,
+// and damaged data fields must be reported rather than decoded.  WOZ
+// images that are cut short or hold bad sizes must be refused or have
+// their bad tracks left out, never read past their ends.
+//
+// usage: testdisk
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define main apple2e_main
+#include "apple2e.cpp"
+#undef main
+
+static int failures = 0;
+
+static void check(bool passed, const char *what)
+{
+    printf("%s: %s\n", passed ? "pass" : "FAIL", what);
+    if(!passed) {
+        failures++;
+    }
+}
+
+// The parser says why it refuses an image on stderr, which the sweeps
+// over every truncated length would fill; send it to /dev/null meanwhile
+static int quiet_stderr()
+{
+    fflush(stderr);
+    int saved = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    if(null != -1) {
+        dup2(null, STDERR_FILENO);
+        close(null);
+    }
+    return saved;
+}
+
+static void restore_stderr(int saved)
+{
+    fflush(stderr);
+    if(saved != -1) {
+        dup2(saved, STDERR_FILENO);
+        close(saved);
+    }
+}
+
+constexpr int trackCount = 35;
+constexpr size_t trackSize = DiskII::sectorsPerTrack * DiskII::sectorSize;
+
+// An image with every byte value in it, plus tracks of all zeroes and all ones
+static vector<uint8_t> make_image()
+{
+    vector<uint8_t> image(trackCount * trackSize);
+    uint32_t seed = 0x12345678;
+    for(size_t i = 0; i < image.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        image[i] = seed >> 24;
+    }
+    std::fill(image.begin(), image.begin() + trackSize, 0x00);
+    std::fill(image.begin() + trackSize, image.begin() + 2 * trackSize, 0xFF);
+    return image;
+}
+
+// Decode every track and count the sectors that were found and came back
+// the same as in the image
+static int decoded_sectors(const vector<uint8_t>& image, const DiskII::NybblizedTracks& tracks, const int *skew)
+{
+    int good = 0;
+    for(int t = 0; t < tracks.count(); t++) {
+        uint8_t floppyTrack[trackSize];
+        bool sectorValid[16];
+        DiskII::denybblizeTrack(tracks.track(t), t, floppyTrack, skew, sectorValid);
+        for(int s = 0; s < DiskII::sectorsPerTrack; s++) {
+            const uint8_t *sector = floppyTrack + s * DiskII::sectorSize;
+            if(sectorValid[s] && (memcmp(sector, image.data() + t * trackSize + s * DiskII::sectorSize, DiskII::sectorSize) == 0)) {
+                good++;
+            }
+        }
+    }
+    return good;
+}
+
+static void test_round_trip(const char *name, const int *skew)
+{
+    vector<uint8_t> image = make_image();
+    DiskII::NybblizedTracks tracks;
+    int count;
+    DiskII::nybblizeFloppy(image.data(), image.size(), tracks, count, skew);
+
+    string what = string(name) + " order image nybblizes to 35 tracks";
+    check((count == trackCount) && (tracks.count() == trackCount), what.c_str());
+
+    what = string(name) + " order sectors all decode to the image";
+    check(decoded_sectors(image, tracks, skew) == trackCount * DiskII::sectorsPerTrack, what.c_str());
+}
+
+// Damage one byte of a data field; only that sector may go missing
+static void test_damaged_sector(uint8_t replacement, const char *what)
+{
+    const int *skew = DiskII::sectorSkewDOS;
+    vector<uint8_t> image = make_image();
+    DiskII::NybblizedTracks tracks;
+    int count;
+    DiskII::nybblizeFloppy(image.data(), image.size(), tracks, count, skew);
+
+    int track = 3, sector = 5;
+    uint8_t *dataField = tracks.writableTrack(track) + DiskII::trackGapSize + sector * DiskII::nybblizedSectorSize + 21;
+    dataField[100] = (dataField[100] != replacement) ? replacement : DiskII::SixBitsToBytes[1];
+
+    uint8_t floppyTrack[trackSize];
+    bool sectorValid[16];
+    DiskII::denybblizeTrack(tracks.track(track), track, floppyTrack, skew, sectorValid);
+    int valid = 0;
+    for(int s = 0; s < DiskII::sectorsPerTrack; s++) {
+        valid += sectorValid[s];
+    }
+    check(!sectorValid[skew[sector]] && (valid == DiskII::sectorsPerTrack - 1), what);
+    check(decoded_sectors(image, tracks, skew) == trackCount * DiskII::sectorsPerTrack - 1, "the rest of the damaged image decodes");
+}
+
+static void put_le16(uint8_t *p, uint32_t v) { p[0] = v; p[1] = v >> 8; }
+static void put_le32(uint8_t *p, uint32_t v) { put_le16(p, v); put_le16(p + 2, v >> 16); }
+
+// Offsets of the pieces of the WOZ 2 image make_woz2() makes
+constexpr size_t wozInfoChunk = 12;
+constexpr size_t wozTmapChunk = wozInfoChunk + 8 + 60;
+constexpr size_t wozTrksChunk = wozTmapChunk + 8 + 160;
+constexpr size_t wozTrackStart = 3 * 512;
+constexpr size_t wozTrackBlocks = 13;
+constexpr uint32_t wozTrackBits = 51200;
+
+// A one track WOZ 2 image with the track under quarter tracks 0 and 1
+static vector<uint8_t> make_woz2()
+{
+    vector<uint8_t> image(wozTrackStart + wozTrackBlocks * 512, 0);
+    memcpy(&image[0], "WOZ2\xFF\x0A\x0D\x0A", 8);
+
+    memcpy(&image[wozInfoChunk], "INFO", 4);
+    put_le32(&image[wozInfoChunk + 4], 60);
+    image[wozInfoChunk + 8] = 2;        // INFO version
+    image[wozInfoChunk + 8 + 1] = 1;    // 5.25 inch
+    image[wozInfoChunk + 8 + 2] = 0;    // not write protected
+
+    memcpy(&image[wozTmapChunk], "TMAP", 4);
+    put_le32(&image[wozTmapChunk + 4], 160);
+    std::fill(&image[wozTmapChunk + 8], &image[wozTmapChunk + 8 + 160], 0xFF);
+    image[wozTmapChunk + 8] = 0;
+    image[wozTmapChunk + 8 + 1] = 0;
+
+    memcpy(&image[wozTrksChunk], "TRKS", 4);
+    put_le32(&image[wozTrksChunk + 4], image.size() - wozTrksChunk - 8);
+    uint8_t *entry = &image[wozTrksChunk + 8];
+    put_le16(entry, wozTrackStart / 512);
+    put_le16(entry + 2, wozTrackBlocks);
+    put_le32(entry + 4, wozTrackBits);
+    for(size_t i = 0; i < wozTrackBlocks * 512; i++) {
+        image[wozTrackStart + i] = 0xFF;
+    }
+    return image;
+}
+
+// Parse a copy of exactly size bytes, so a checker like valgrind sees any
+// read past the end.  The tracks found must lie inside it, and are pointed
+// back into image for the caller.
+static bool parse_woz(const vector<uint8_t>& image, size_t size, vector<DiskII::BitTrack>& tracks, bool& inBounds)
+{
+    uint8_t *copy = new uint8_t[size];
+    memcpy(copy, image.data(), size);
+    uint8_t quarterTrackMap[160];
+    bool writeProtected;
+    tracks.clear();
+    bool success = DiskII::readWozImage(copy, size, quarterTrackMap, tracks, writeProtected);
+    inBounds = true;
+    for(auto& track: tracks) {
+        if(track.bits) {
+            if(success && ((track.bits < copy) || (track.bits + (track.bitCount + 7) / 8 > copy + size))) {
+                inBounds = false;
+            }
+            track.bits = image.data() + (track.bits - copy);
+        }
+    }
+    delete[] copy;
+    return success;
+}
+
+static void test_woz()
+{
+    vector<uint8_t> image = make_woz2();
+    vector<DiskII::BitTrack> tracks;
+    bool inBounds;
+
+    bool success = parse_woz(image, image.size(), tracks, inBounds);
+    check(success && inBounds && (tracks.size() == 160) && (tracks[0].bits == image.data() + wozTrackStart) &&
+        (tracks[0].bitCount == wozTrackBits) && (tracks[1].bitCount == 0), "WOZ 2 image parses");
+
+    // Every shorter length cuts off the TRKS chunk, or more
+    bool refused = true;
+    int saved = quiet_stderr();
+    for(size_t size = 0; size < image.size(); size++) {
+        if(parse_woz(image, size, tracks, inBounds) || !inBounds) {
+            refused = false;
+        }
+    }
+    restore_stderr(saved);
+    check(refused, "WOZ 2 image cut short anywhere is refused");
+
+    vector<uint8_t> bad = image;
+    put_le32(&bad[wozTmapChunk + 4], 0xFFFFFFF8);
+    check(!parse_woz(bad, bad.size(), tracks, inBounds), "WOZ chunk size that wraps around is refused");
+
+    bad = image;
+    memcpy(&bad[0], "WOZ3", 4);
+    check(!parse_woz(bad, bad.size(), tracks, inBounds), "image that isn't WOZ 1 or 2 is refused");
+
+    bad = image;
+    bad[wozInfoChunk + 8 + 1] = 2;
+    check(!parse_woz(bad, bad.size(), tracks, inBounds), "3.5 inch WOZ image is refused");
+
+    // A track running past the end of the file, or starting in its header,
+    // is left out and the rest of the image is kept
+    bad = image;
+    put_le32(&bad[wozTrksChunk + 8 + 4], wozTrackBlocks * 512 * 8 + 1);
+    success = parse_woz(bad, bad.size(), tracks, inBounds);
+    check(success && inBounds && (tracks[0].bitCount == 0), "WOZ 2 track running past the end is left out");
+
+    bad = image;
+    put_le16(&bad[wozTrksChunk + 8], 0);
+    success = parse_woz(bad, bad.size(), tracks, inBounds);
+    check(success && inBounds && (tracks[0].bitCount == 0), "WOZ 2 track at block 0 is left out");
+
+    // WOZ 1 keeps its tracks in the TRKS chunk, 6656 bytes each, with the
+    // bit count after the bits
+    vector<uint8_t> woz1(wozTrksChunk + 8 + 6656, 0);
+    memcpy(&woz1[0], image.data(), wozTrksChunk);
+    woz1[3] = '1';
+    memcpy(&woz1[wozTrksChunk], "TRKS", 4);
+    put_le32(&woz1[wozTrksChunk + 4], 6656);
+    put_le16(&woz1[wozTrksChunk + 8 + 6648], 6646 * 8);
+    success = parse_woz(woz1, woz1.size(), tracks, inBounds);
+    check(success && inBounds && (tracks.size() == 1) && (tracks[0].bitCount == 6646 * 8), "WOZ 1 image parses");
+
+    put_le16(&woz1[wozTrksChunk + 8 + 6648], 6646 * 8 + 1);
+    success = parse_woz(woz1, woz1.size(), tracks, inBounds);
+    check(success && inBounds && (tracks[0].bitCount == 0), "WOZ 1 track longer than its buffer is left out");
+
+    refused = true;
+    saved = quiet_stderr();
+    for(size_t size = 0; size < woz1.size(); size++) {
+        if(parse_woz(woz1, size, tracks, inBounds) || !inBounds) {
+            refused = false;
+        }
+    }
+    restore_stderr(saved);
+    check(refused, "WOZ 1 image cut short anywhere is refused");
+}
+
+int main(int argc, char **argv)
+{
+    test_round_trip("DOS", DiskII::sectorSkewDOS);
+    test_round_trip("ProDOS", DiskII::sectorSkewProDOS);
+
+    // 0x00 can't be in a data field; 0x96 can, so only the checksum catches it
+    test_damaged_sector(0x00, "data field with a byte that isn't a disk byte is rejected");
+    test_damaged_sector(0x96, "data field with a bad checksum is rejected");
+
+    vector<uint8_t> image = make_image();
+    image.resize(image.size() + 100);
+    DiskII::NybblizedTracks tracks;
+    int count;
+    DiskII::nybblizeFloppy(image.data(), image.size(), tracks, count, DiskII::sectorSkewDOS);
+    check(count == trackCount, "partial track at the end of an image is left out");
+
+    test_woz();
+
+    exit((failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,263 @@
+// Checks that a save state holds all of a machine's state: saving a loaded
+// state gives back the same bytes, and a machine running on from a loaded
+// state stays in step with one that was never saved.  So must both sides
+// of a fork, and a machine rewound to an earlier cycle.  Replaying an
+// input log, with or without the translator, must end where the
+// recorded run did.
+//
+// usage: teststate apple2e.rom diskII.c600.c6ff.bin floppy.dsk [cycles]
+
+#include <unistd.h>
+
+#define main apple2e_main
+#include "apple2e.cpp"
+#undef main
+
+static bool read_file(const char *name, vector<uint8_t>& contents)
+{
+    FILE *fp = fopen(name, "rb");
+    if(!fp) {
+        return false;
+    }
+    contents.clear();
+    uint8_t buffer[4096];
+    size_t got;
+    while((got = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        contents.insert(contents.end(), buffer, buffer + got);
+    }
+    fclose(fp);
+    return true;
+}
+
+static string temporary_name()
+{
+    char name[] = "/tmp/teststateXXXXXX";
+    int fd = mkstemp(name);
+    if(fd == -1) {
+        return "";
+    }
+    close(fd);
+    return name;
+}
+
+// Print and count where two machines differ
+static int compare_machines(apple2e_instance *a, apple2e_instance *b)
+{
+    int differences = 0;
+    if((a->clk.clock_cpu != b->clk.clock_cpu) || (a->clk.clock_14mhz != b->clk.clock_14mhz)) {
+        printf("clocks differ: %llu vs %llu\n", (unsigned long long)a->clk.clock_cpu, (unsigned long long)b->clk.clock_cpu);
+        differences++;
+    }
+    if((a->cpu.a != b->cpu.a) || (a->cpu.x != b->cpu.x) || (a->cpu.y != b->cpu.y) ||
+        (a->cpu.s != b->cpu.s) || (a->cpu.p != b->cpu.p) || (a->cpu.pc != b->cpu.pc)) {
+        printf("registers differ: PC %04X vs %04X\n", a->cpu.pc, b->cpu.pc);
+        differences++;
+    }
+    for(size_t r = 0; r < a->board->regions.size(); r++) {
+        backed_region *ra = a->board->regions[r];
+        backed_region *rb = b->board->regions[r];
+        for(int i = 0; i < ra->memory.size(); i++) {
+            if(ra->memory[i] != rb->memory[i]) {
+                printf("%s differs at offset %04X: %02X vs %02X\n", ra->name.c_str(), i, ra->memory[i], rb->memory[i]);
+                differences++;
+                break;
+            }
+        }
+    }
+    return differences;
+}
+
+// Run to end applying the replayed inputs, stepping one instruction at
+// a time near each so it lands on its exact cycle, as headless runs do
+static void replay_until(apple2e_instance *machine, clk_t end)
+{
+    while(machine->clk.clock_cpu < end) {
+        machine->replay_inputs();
+        clk_t next = machine->next_replay_clock();
+        if(next - machine->clk.clock_cpu <= machine->cpu.max_cycles_per_cycle) {
+            machine->step();
+        } else {
+            machine->run_until(min(next - machine->cpu.max_cycles_per_cycle, end));
+        }
+    }
+}
+
+// Save both machines' states and compare the files
+static bool same_state(apple2e_instance *a, apple2e_instance *b)
+{
+    string a_name = temporary_name();
+    string b_name = temporary_name();
+    vector<uint8_t> a_state, b_state;
+    bool saved = !a_name.empty() && !b_name.empty() &&
+        a->save_state(a_name.c_str()) && b->save_state(b_name.c_str()) &&
+        read_file(a_name.c_str(), a_state) && read_file(b_name.c_str(), b_state);
+    unlink(a_name.c_str());
+    unlink(b_name.c_str());
+    return saved && !a_state.empty() && (a_state == b_state);
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 4) {
+        fprintf(stderr, "usage: %s apple2e.rom diskII.c600.c6ff.bin floppy.dsk [cycles]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    clk_t cycles = (argc > 4) ? strtoull(argv[4], NULL, 0) : 3000000;
+
+    uint8_t rom[32768];
+    uint8_t diskII_rom[256];
+    if(!read_blob(argv[1], rom, sizeof(rom)) || !read_blob(argv[2], diskII_rom, sizeof(diskII_rom))) {
+        exit(EXIT_FAILURE);
+    }
+
+    int failures = 0;
+
+    // Boot partway, save, load the state into a second machine, and save
+    // that one; the two files must be the same byte for byte
+    apple2e_instance *original = new_headless_machine(rom, diskII_rom, argv[3], NULL, false, false, false, false);
+    original->diskII->writeBack = false;
+    original->run_until(cycles);
+
+    string first_name = temporary_name();
+    string second_name = temporary_name();
+    if(first_name.empty() || second_name.empty()) {
+        fprintf(stderr, "couldn't make temporary files\n");
+        exit(EXIT_FAILURE);
+    }
+
+    apple2e_instance *loaded = new_headless_machine(rom, diskII_rom, argv[3], NULL, false, false, false, false);
+    loaded->diskII->writeBack = false;
+    if(!original->save_state(first_name.c_str()) || !loaded->load_state(first_name.c_str()) || !loaded->save_state(second_name.c_str())) {
+        printf("FAIL: save, load, save\n");
+        failures++;
+    } else {
+        vector<uint8_t> first, second;
+        read_file(first_name.c_str(), first);
+        read_file(second_name.c_str(), second);
+        if(first.empty() || (first != second)) {
+            printf("FAIL: state saved after loading (%zd bytes) differs from the one loaded (%zd bytes)\n", second.size(), first.size());
+            failures++;
+        } else {
+            printf("pass: save, load, save gives the same %zd bytes\n", first.size());
+        }
+    }
+    unlink(first_name.c_str());
+    unlink(second_name.c_str());
+
+    // Run both on for the same number of cycles; the loaded one must end
+    // up where the one that was never saved does
+    if(compare_machines(original, loaded) != 0) {
+        printf("FAIL: machine differs right after loading\n");
+        failures++;
+    }
+    original->run_until(cycles * 2);
+    loaded->run_until(cycles * 2);
+    if(compare_machines(original, loaded) != 0) {
+        printf("FAIL: machine run on from a loaded state differs from one run without stopping\n");
+        failures++;
+    } else {
+        printf("pass: %llu cycles after loading match an uninterrupted run\n", (unsigned long long)cycles);
+    }
+
+    // Fork a machine partway and run parent and child on; each must end
+    // up where the one that was never forked does
+    apple2e_instance *parent = new_headless_machine(rom, diskII_rom, argv[3], NULL, false, false, false, false);
+    parent->diskII->writeBack = false;
+    parent->run_until(cycles);
+    apple2e_instance *child = parent->fork();
+    parent->run_until(cycles * 2);
+    child->run_until(cycles * 2);
+    if(compare_machines(original, parent) != 0) {
+        printf("FAIL: machine run on after forking differs from one never forked\n");
+        failures++;
+    } else if(compare_machines(original, child) != 0) {
+        printf("FAIL: forked child run on differs from a machine never forked\n");
+        failures++;
+    } else {
+        printf("pass: parent and child run on %llu cycles after forking match an uninterrupted run\n", (unsigned long long)cycles);
+    }
+    delete child;
+    delete parent;
+
+    // Rewind a machine to a cycle partway through its run; it must match
+    // a machine run straight to that cycle, and keep matching the
+    // uninterrupted one when run on
+    apple2e_instance *rewound = new_headless_machine(rom, diskII_rom, argv[3], NULL, false, false, false, false);
+    rewound->diskII->writeBack = false;
+    rewound->enable_rewind(cycles / 8, 16);
+    while(rewound->clk.clock_cpu < cycles * 2) {
+        rewound->checkpoint_if_due();
+        rewound->run_until(min(rewound->clk.clock_cpu + 17030, cycles * 2));
+    }
+    clk_t target = cycles + cycles / 3;
+    apple2e_instance *straight = new_headless_machine(rom, diskII_rom, argv[3], NULL, false, false, false, false);
+    straight->diskII->writeBack = false;
+    straight->run_until(target);
+    if(!rewound->rewind_to(target)) {
+        printf("FAIL: rewind to cycle %llu\n", (unsigned long long)target);
+        failures++;
+    } else if(compare_machines(straight, rewound) != 0) {
+        printf("FAIL: machine rewound to cycle %llu differs from one run straight there\n", (unsigned long long)target);
+        failures++;
+    } else {
+        while(rewound->clk.clock_cpu < cycles * 2) {
+            rewound->checkpoint_if_due();
+            rewound->run_until(min(rewound->clk.clock_cpu + 17030, cycles * 2));
+        }
+        if(compare_machines(original, rewound) != 0) {
+            printf("FAIL: machine run on after rewinding differs from an uninterrupted run\n");
+            failures++;
+        } else {
+            printf("pass: rewinding to cycle %llu matches a run straight there, and running on from it an uninterrupted run\n", (unsigned long long)target);
+        }
+    }
+    delete straight;
+    delete rewound;
+
+    // Record a run with keys typed partway, then replay the log with the
+    // interpreter and with the translator; both must end in the recorded
+    // machine's state byte for byte
+    string log_name = temporary_name();
+    apple2e_instance *recorded = new_headless_machine(rom, diskII_rom, argv[3], NULL, false, false, false, false);
+    recorded->diskII->writeBack = false;
+    if(log_name.empty() || !recorded->start_recording(log_name.c_str())) {
+        fprintf(stderr, "couldn't make temporary files\n");
+        exit(EXIT_FAILURE);
+    }
+    // Keys are typed as -keys does, each once the last has been read,
+    // through the title screen's pause to the menu's disk catalog
+    const char *typed = "  1";
+    recorded->run_until(cycles);
+    while(recorded->clk.clock_cpu < cycles * 6) {
+        if((*typed != '\0') && recorded->board->keyboard_buffer.empty()) {
+            recorded->apply_input(input_event(recorded->clk.clock_cpu, input_event::KEY, *typed++));
+        }
+        recorded->run_until(recorded->clk.clock_cpu + 17030);
+    }
+    recorded->stop_recording();
+    for(bool jit : {false, true}) {
+        const char *how = jit ? "translator" : "interpreter";
+        apple2e_instance *replayed = new_headless_machine(rom, diskII_rom, argv[3], NULL, false, jit, false, false);
+        replayed->diskII->writeBack = false;
+        if(!replayed->start_replay(log_name.c_str())) {
+            printf("FAIL: replay with the %s\n", how);
+            failures++;
+        } else {
+            replay_until(replayed, recorded->clk.clock_cpu);
+            if((compare_machines(recorded, replayed) != 0) || !same_state(recorded, replayed)) {
+                printf("FAIL: replaying with the %s differs from the recorded run\n", how);
+                failures++;
+            } else {
+                printf("pass: replaying with the %s matches the recorded run\n", how);
+            }
+        }
+        delete replayed;
+    }
+    unlink(log_name.c_str());
+    delete recorded;
+
+    delete original;
+    delete loaded;
+
+    exit((failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,1093 @@
+#include <cstring>
+
+#include "video_render.h"
+
+namespace APPLE2Einterface
+{
+
+extern const uint8_t font_bytes[96 * 7 * 8];
+
+const uint8_t artifact_colors[16][3] = {
+    {  0,   0,   0}, //  0 "black"       -> 0,0,0,0 -> {0.000000, 0.000000, 0.000000}
+    {208,   0,  50}, //  1 "red"         -> 1,0,0,0 -> {0.815901, 0.000000, 0.197238}
+    { 72,  11, 255}, //  2 "dark blue"   -> 0,1,0,0 -> {0.283288, 0.043435, 1.000000}
+    {255,   3, 255}, //  3 "purple"      -> 1,1,0,0 -> {1.000000, 0.015525, 1.000000}
+    {  0, 134,  77}, //  4 "dark green"  -> 0,0,1,0 -> {0.000000, 0.527909, 0.302762}
+    {127, 127, 127}, //  5 "gray 1"      -> 1,0,1,0 -> {0.500000, 0.500000, 0.500000}
+    {  0, 145, 255}, //  6 "medium blue" -> 0,1,1,0 -> {0.000000, 0.571344, 1.000000}
+    {199, 138, 255}, //  7 "light blue"  -> 1,1,1,0 -> {0.783288, 0.543435, 1.000000}
+    { 55, 116,   0}, //  8 "brown"       -> 0,0,0,1 -> {0.216712, 0.456565, 0.000000}
+    {255, 109,   0}, //  9 "orange"      -> 1,0,0,1 -> {1.000000, 0.428656, 0.000000}
+    {127, 127, 127}, // 10 "gray 2"      -> 0,1,0,1 -> {0.500000, 0.500000, 0.500000}
+    {255, 120, 177}, // 11 "pink"        -> 1,1,0,1 -> {1.000000, 0.472091, 0.697238}
+    {  0, 251,   0}, // 12 "light green" -> 0,0,1,1 -> {0.000000, 0.984475, 0.000000}
+    {182, 243,   0}, // 13 "yello"       -> 1,0,1,1 -> {0.716712, 0.956565, 0.000000}
+    { 46, 255, 204}, // 14 "aqua"        -> 0,1,1,1 -> {0.184099, 1.000000, 0.802762}
+    {255, 255, 255}, // 15 "white"       -> 1,1,1,1 -> {1.000000, 1.000000, 1.000000}
+};
+
+static constexpr uint8_t black = 0;
+static constexpr uint8_t white = 15;
+
+// Lookup tables for drawing a byte of display memory at a time
+struct video_tables
+{
+    uint8_t byte_dots[256][7]; // bits 0-6 as 0 or 1, leftmost dot first
+    uint8_t text_dots[2][256][8]; // [blink][character][row] as bits 0-6
+    uint8_t hires_colors[32]; // by left | dot << 1 | right << 2 | odd x << 3 | palette << 4
+    uint8_t dhgr_colors[4][16]; // [phase][dot three back | two back << 1 | one back << 2 | dot << 3]
+
+    video_tables()
+    {
+        for(int b = 0; b < 256; b++) {
+            for(int i = 0; i < 7; i++) {
+                byte_dots[b][i] = (b >> i) & 1;
+            }
+        }
+
+        // 0-31 is inverse 32-63
+        // 32-63 is inverse 0-31
+        // 64-95 is blink 32-63
+        // 96-127 is blink 0-31
+        // 128-159 is normal 32-63
+        // 160-191 is normal 0-31
+        // 192-223 is normal 32-63
+        // 224-255 is normal 64-95
+        static const int glyph_bases[8] = {32, 0, 32, 0, 32, 0, 32, 64};
+        for(int blink = 0; blink < 2; blink++) {
+            for(int c = 0; c < 256; c++) {
+                int glyph = c % 32 + glyph_bases[c / 32];
+                bool inverse = (c < 64) || ((c < 128) && blink);
+                for(int row = 0; row < 8; row++) {
+                    uint8_t bits = 0;
+                    for(int x = 0; x < 7; x++) {
+                        bool on = font_bytes[(glyph * 8 + row) * 7 + x] != 0;
+                        bits |= (on != inverse) << x;
+                    }
+                    text_dots[blink][c][row] = bits;
+                }
+            }
+        }
+
+        // A dot next to another is white, a lone dot is the color of its
+        // column's phase and palette, as in hirescolor_fragment_shader
+        for(int i = 0; i < 32; i++) {
+            int left = i & 1, dot = (i >> 1) & 1, right = (i >> 2) & 1, odd = (i >> 3) & 1, palette = (i >> 4) & 1;
+            int even_dot = odd ? left : dot;
+            int odd_dot = odd ? dot : right;
+            if(dot && (left || right)) {
+                hires_colors[i] = white;
+            } else if(even_dot == odd_dot) {
+                hires_colors[i] = black;
+            } else if(palette == 0) {
+                hires_colors[i] = odd_dot ? 12 : 3; // green, purple
+            } else {
+                hires_colors[i] = odd_dot ? 9 : 6; // orange, medium blue
+            }
+        }
+
+        // The last four dots make the color, rotated by where the dot
+        // falls in the color cycle, as in dhgrcolor_fragment_shader
+        for(int phase = 0; phase < 4; phase++) {
+            for(int i = 0; i < 16; i++) {
+                int D = i & 1, C = (i >> 1) & 1, B = (i >> 2) & 1, A = (i >> 3) & 1;
+                int bits[4] = {A, B, C, D};
+                int color = 0;
+                for(int k = 0; k < 4; k++) {
+                    color |= bits[k] << ((phase - k + 4) % 4);
+                }
+                dhgr_colors[phase][i] = color;
+            }
+        }
+    }
+};
+
+static const video_tables& tables()
+{
+    static const video_tables t;
+    return t;
+}
+
+static int text_row_offset(int row)
+{
+    return (row % 8) * 0x80 + (row / 8) * 0x28;
+}
+
+static int hires_row_offset(int y)
+{
+    return (y % 8) * 0x400 + ((y / 8) % 8) * 0x80 + (y / 64) * 0x28;
+}
+
+static void render_text_line(const video_memory& memory, const ModeSettings& settings, int y, bool blink, uint8_t *out)
+{
+    const video_tables& t = tables();
+    int offset = text_row_offset(y / 8);
+    const uint8_t *main = memory.text[0][settings.page] + offset;
+    const uint8_t *aux = memory.text[1][settings.page] + offset;
+    if(settings.vid80) {
+        for(int col = 0; col < 80; col++) {
+            uint8_t c = (col % 2) ? main[col / 2] : aux[col / 2];
+            const uint8_t *dots = t.byte_dots[t.text_dots[blink][c][y % 8]];
+            for(int i = 0; i < 7; i++) {
+                out[col * 7 + i] = dots[i] * white;
+            }
+        }
+    } else {
+        for(int col = 0; col < 40; col++) {
+            const uint8_t *dots = t.byte_dots[t.text_dots[blink][main[col]][y % 8]];
+            for(int i = 0; i < 7; i++) {
+                out[col * 14 + i * 2] = out[col * 14 + i * 2 + 1] = dots[i] * white;
+            }
+        }
+    }
+}
+
+static void render_lores_line(const video_memory& memory, const ModeSettings& settings, int y, uint8_t *out)
+{
+    const uint8_t *main = memory.text[0][settings.page] + text_row_offset(y / 8);
+    for(int col = 0; col < 40; col++) {
+        uint8_t color = ((y % 8) < 4) ? (main[col] & 0x0F) : (main[col] >> 4);
+        memset(out + col * 14, color, 14);
+    }
+}
+
+static void render_hires_line(const video_memory& memory, const ModeSettings& settings, int y, bool color, uint8_t *out)
+{
+    const video_tables& t = tables();
+    const uint8_t *main = memory.hires[0][settings.page] + hires_row_offset(y);
+    uint8_t dots[1 + 280 + 1] = {}; // with a dark dot off each end
+    uint8_t palettes[280];
+    for(int col = 0; col < 40; col++) {
+        memcpy(dots + 1 + col * 7, t.byte_dots[main[col]], 7);
+        memset(palettes + col * 7, main[col] >> 7, 7);
+    }
+    uint8_t line[280];
+    if(color) {
+        for(int x = 0; x < 280; x++) {
+            line[x] = t.hires_colors[dots[x] | (dots[x + 1] << 1) | (dots[x + 2] << 2) | ((x & 1) << 3) | (palettes[x] << 4)];
+        }
+    } else {
+        for(int x = 0; x < 280; x++) {
+            line[x] = dots[x + 1] * white;
+        }
+    }
+    for(int x = 0; x < 280; x++) {
+        out[x * 2] = out[x * 2 + 1] = line[x];
+    }
+}
+
+static void render_dhgr_line(const video_memory& memory, const ModeSettings& settings, int y, bool color, uint8_t *out)
+{
+    const video_tables& t = tables();
+    int offset = hires_row_offset(y);
+    const uint8_t *main = memory.hires[0][settings.page] + offset;
+    const uint8_t *aux = memory.hires[1][settings.page] + offset;
+    uint8_t dots[3 + 560] = {}; // with three dark dots before the line
+    for(int col = 0; col < 40; col++) {
+        memcpy(dots + 3 + col * 14, t.byte_dots[aux[col]], 7);
+        memcpy(dots + 3 + col * 14 + 7, t.byte_dots[main[col]], 7);
+    }
+    if(color) {
+        for(int x = 0; x < 560; x++) {
+            out[x] = t.dhgr_colors[(x + 1) % 4][dots[x] | (dots[x + 1] << 1) | (dots[x + 2] << 2) | (dots[x + 3] << 3)];
+        }
+    } else {
+        for(int x = 0; x < 560; x++) {
+            out[x] = dots[x + 3] * white;
+        }
+    }
+}
+
+void render_video(const video_memory& memory, const ModeSettings line_modes[video_frame_height], bool color, bool blink, uint8_t *pixels)
+{
+    for(int y = 0; y < video_frame_height; y++) {
+        const ModeSettings& settings = line_modes[y];
+        uint8_t *out = pixels + y * video_frame_width;
+        if((settings.mode == TEXT) || (settings.mixed && (y >= 160))) {
+            render_text_line(memory, settings, y, blink, out);
+        } else if(settings.mode == LORES) {
+            render_lores_line(memory, settings, y, out);
+        } else if(settings.dhgr) {
+            render_dhgr_line(memory, settings, y, color, out);
+        } else {
+            render_hires_line(memory, settings, y, color, out);
+        }
+    }
+}
+
+void video_pixels_to_rgb(const uint8_t *pixels, uint8_t *rgb)
+{
+    for(int i = 0; i < video_frame_width * video_frame_height; i++) {
+        memcpy(rgb + i * 3, artifact_colors[pixels[i] & 0x0F], 3);
+    }
+}
+
+uint16_t font_offset = 32;
+const uint8_t font_bytes[96 * 7 * 8] = {
+    // 32 :  
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 33 : !
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 34 : "
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 35 : #
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 36 : $
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 37 : %
+    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 38 : &
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 39 : '
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 40 : (
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 41 : )
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 42 : *
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 43 : +
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 44 : ,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 45 : -
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 46 : .
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 47 : /
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 48 : 0
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 49 : 1
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 50 : 2
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 51 : 3
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 52 : 4
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 53 : 5
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 54 : 6
+    0x00,0x00,0x00,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 55 : 7
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 56 : 8
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 57 : 9
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 58 : :
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 59 : ;
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 60 : <
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 61 : =
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 62 : >
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 63 : ?
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 64 : @
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 65 : A
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 66 : B
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 67 : C
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 68 : D
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 69 : E
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 70 : F
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 71 : G
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 72 : H
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 73 : I
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 74 : J
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 75 : K
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 76 : L
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 77 : M
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0x00,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 78 : N
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 79 : O
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 80 : P
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 81 : Q
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 82 : R
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 83 : S
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 84 : T
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 85 : U
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 86 : V
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 87 : W
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0x00,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 88 : X
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 89 : Y
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 90 : Z
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 91 : [
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 92 : backslash
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 93 : ]
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 94 : ^
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 95 : _
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    // 96 : `
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 97 : a
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 98 : b
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 99 : c
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 100 : d
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 101 : e
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 102 : f
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 103 : g
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    // 104 : h
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 105 : i
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 106 : j
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
+    // 107 : k
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 108 : l
+    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 109 : m
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0x00,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 110 : n
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 111 : o
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 112 : p
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    // 113 : q
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    // 114 : r
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 115 : s
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 116 : t
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 117 : u
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 118 : v
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 119 : w
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0xFF,0x00,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 120 : x
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 121 : y
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0xFF,0x00,0x00,
+    // 122 : z
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 123 : {
+    0x00,0x00,0x00,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 124 : |
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0x00,0x00,0x00,
+    // 125 : }
+    0x00,0xFF,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0xFF,0xFF,0xFF,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 126 : ~
+    0x00,0x00,0xFF,0xFF,0x00,0xFF,0x00,
+    0x00,0xFF,0x00,0xFF,0xFF,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    // 127 : 
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0x00,0xFF,0x00,0xFF,0x00,0x00,
+    0x00,0xFF,0x00,0xFF,0x00,0xFF,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+};
+
+};
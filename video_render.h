@@ -0,0 +1,44 @@
+/*
+    Draws the Apple //e display on the CPU, the same way interface.cpp's
+    shaders do, for runs with no GPU and as a reference to check the
+    shaders against.
+
+    Frames are 560 by 192 pixels, one byte per pixel holding an index into
+    artifact_colors[], so 80-column text and double hi-res get one frame
+    pixel per dot and everything else gets two.
+
+        render_video(memory, line_modes, color, blink, pixels) - draw each
+            of the 192 scanlines from the video pages with the settings the
+            beam saw on that line; color picks artifact colors for hi-res
+            instead of white dots, blink shows flashing text inverse
+        video_pixels_to_rgb(pixels, rgb) - expand a frame to 8-bit RGB
+*/
+
+#ifndef VIDEO_RENDER_H
+#define VIDEO_RENDER_H
+
+#include <stdint.h>
+
+#include "interface.h"
+
+namespace APPLE2Einterface
+{
+
+constexpr int video_frame_width = 560;
+constexpr int video_frame_height = 192;
+
+extern const uint8_t artifact_colors[16][3];
+
+// The display memory as it is laid out on the machine, [aux][page]
+struct video_memory
+{
+    const uint8_t *text[2][2]; // 0x400 bytes from $400 or $800
+    const uint8_t *hires[2][2]; // 0x2000 bytes from $2000 or $4000
+};
+
+void render_video(const video_memory& memory, const ModeSettings line_modes[video_frame_height], bool color, bool blink, uint8_t *pixels);
+void video_pixels_to_rgb(const uint8_t *pixels, uint8_t *rgb);
+
+};
+
+#endif /* VIDEO_RENDER_H */